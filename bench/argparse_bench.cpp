@@ -0,0 +1,549 @@
+// Parse throughput benchmarks.
+//
+//   argparse_bench [FILTER]
+//
+// runs every benchmark whose name contains FILTER and prints one CSV row per
+// benchmark after a header row. Names and columns stay fixed across releases
+// so that the output of two builds can be joined on the benchmark column.
+// Each row is the median of several repetitions; cycles_per_token is 0 where
+// no time stamp counter is available.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "argparse.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ARGPARSE_BENCH_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ARGPARSE_BENCH_HAS_TSC 1
+#endif
+
+namespace {
+
+constexpr int repetitions = 5;
+
+char const* filter = "";
+
+// flags and options of tests/ls_test.cpp, without the help texts
+argparse::ArgParser make_ls_parser() {
+  argparse::ArgParser parser;
+  for (auto const* flag : {"@", "A", "B", "C", "F", "H", "I", "L", "O", "P",
+                           "R", "S", "T", "U", "W", "a", "b", "c", "d", "e",
+                           "f", "g", "h", "i", "k", "l", "m", "n", "o", "p",
+                           "q", "r", "s", "t", "u", "v", "w", "x", "y", "%",
+                           "1"}) {
+    parser.add_flag(flag);
+  }
+  parser.add_option("D").value_help("FORMAT");
+  parser.add_option("color").set_default("when");
+  parser.add_alias_flag("G", {"color", "auto"});
+  parser.add_positional<std::vector<std::string>>("files_or_directories");
+  return parser;
+}
+
+// flags and options of tests/getopt_test.cpp, without the help texts
+argparse::ArgParser make_getopt_parser() {
+  argparse::ArgParser parser;
+  parser.add_flag("a,alternative");
+  parser.add_flag("h,help");
+  parser.add_option("l,longoptions");
+  parser.add_option("n,name");
+  parser.add_option("o,options");
+  parser.add_flag("q,quiet");
+  parser.add_flag("Q,quiet-output");
+  parser.add_option("s,shell");
+  parser.add_flag("T,test");
+  parser.add_flag("u,unquoted");
+  parser.add_flag("V,version");
+  parser.add_positional("parameters");
+  return parser;
+}
+
+// flags and options of tests/grep_test.cpp, without the help texts
+argparse::ArgParser make_grep_parser() {
+  argparse::ArgParser parser;
+  parser.add_flag("E,extended-regexp");
+  parser.add_flag("F,fixed-strings");
+  parser.add_flag("G,basic-regexp");
+  parser.add_flag("P,perl-regexp");
+  parser.add_option("e,regexp");
+  parser.add_option("f,file");
+  parser.add_option("i,ignore-case");
+  parser.add_option("w,word-regexp");
+  parser.add_option("x,line-regexp");
+  parser.add_option("z,null-data");
+  parser.add_flag("s,no-messages");
+  parser.add_flag("v,invert-match");
+  parser.add_flag("V,version");
+  parser.add_flag("help");
+  parser.add_option<int>("m,max-count");
+  parser.add_flag("b,byte-offset");
+  parser.add_flag("n,line-number");
+  parser.add_flag("line-buffered");
+  parser.add_flag("H,with-filename");
+  parser.add_flag("h,no-filename");
+  parser.add_option("label");
+  parser.add_flag("o,only-matching");
+  parser.add_flag("q,quiet");
+  parser.add_option("binary-files");
+  parser.add_alias_flag("a,text", {"binary-files", "text"});
+  parser.add_alias_flag("I", {"binary-files", "without-match"});
+  parser.add_option("d,directories");
+  parser.add_option("D,devices");
+  parser.add_flag("r,recursive");
+  parser.add_flag("R,dereference-recursive");
+  parser.add_option("include");
+  parser.add_option("exclude");
+  parser.add_option("exclude-from");
+  parser.add_option("exclude-dir");
+  parser.add_flag("L,files-without-match");
+  parser.add_flag("l,files-with-matches");
+  parser.add_flag("c,count");
+  parser.add_flag("T,initial-tab");
+  parser.add_flag("Z,null");
+  parser.add_option<int>("B,before-context");
+  parser.add_option<int>("A,after-context");
+  parser.add_option<int>("C,context");
+  parser.add_option("group-separator");
+  parser.add_flag("no-group-separator");
+  parser.add_option("color,colour");
+  parser.add_flag("U,binary");
+  parser.add_positional("pattern_and_files");
+  return parser;
+}
+
+// ten members of a config struct, bench_startup() binds twenty of them
+struct Tunables {
+  int a{0};
+  int b{0};
+  int c{0};
+  int d{0};
+  int e{0};
+  int f{0};
+  int g{0};
+  int h{0};
+  int i{0};
+  int j{0};
+};
+
+constexpr int Tunables::*tunable_members[] = {
+    &Tunables::a, &Tunables::b, &Tunables::c, &Tunables::d, &Tunables::e,
+    &Tunables::f, &Tunables::g, &Tunables::h, &Tunables::i, &Tunables::j};
+
+// the bind_struct() table of a Tunables, named by names[0..9]
+std::vector<argparse::StructField<Tunables>> tunable_fields(
+    std::string const* names) {
+  return {argparse::field<&Tunables::a>(names[0], "a tunable"),
+          argparse::field<&Tunables::b>(names[1], "a tunable"),
+          argparse::field<&Tunables::c>(names[2], "a tunable"),
+          argparse::field<&Tunables::d>(names[3], "a tunable"),
+          argparse::field<&Tunables::e>(names[4], "a tunable"),
+          argparse::field<&Tunables::f>(names[5], "a tunable"),
+          argparse::field<&Tunables::g>(names[6], "a tunable"),
+          argparse::field<&Tunables::h>(names[7], "a tunable"),
+          argparse::field<&Tunables::i>(names[8], "a tunable"),
+          argparse::field<&Tunables::j>(names[9], "a tunable")};
+}
+
+std::uint64_t ticks() {
+#ifdef ARGPARSE_BENCH_HAS_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Runs f() iterations times per repetition, each call parsing argvs command
+// lines of tokens arguments in total, and prints the median repetition.
+// argvs is 0 for benchmarks which do not parse.
+template <typename F>
+void run(std::string const& name,
+         long iterations,
+         long tokens,
+         long argvs,
+         F&& f) {
+  if (name.find(filter) == std::string::npos) {
+    return;
+  }
+  for (long i = 0; i < iterations / 10; i++) {
+    f();
+  }
+  struct Sample {
+    double ns;
+    double ticks;
+  };
+  std::vector<Sample> samples;
+  for (int r = 0; r < repetitions; r++) {
+    auto const start = std::chrono::steady_clock::now();
+    auto const start_ticks = ticks();
+    for (long i = 0; i < iterations; i++) {
+      f();
+    }
+    auto const elapsed_ticks = static_cast<double>(ticks() - start_ticks);
+    auto const elapsed = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    samples.push_back({elapsed, elapsed_ticks});
+  }
+  std::sort(samples.begin(), samples.end(),
+            [](Sample a, Sample b) { return a.ns < b.ns; });
+  auto const median = samples[repetitions / 2];
+  auto const ns_per_op = median.ns / static_cast<double>(iterations);
+  auto const ns_per_token = ns_per_op / static_cast<double>(tokens);
+  std::printf("%s,%ld,%.1f,%.2f,%.0f,%.0f,%.1f\n", name.c_str(), iterations,
+              ns_per_op, ns_per_token, 1e9 / ns_per_token,
+              static_cast<double>(argvs) * 1e9 / ns_per_op,
+              median.ticks / static_cast<double>(iterations) /
+                  static_cast<double>(tokens));
+}
+
+// parses cmd, whose first element is the program name, over and over
+void run_argv(std::string const& name,
+              long iterations,
+              argparse::ArgParser& parser,
+              std::vector<const char*> const& cmd) {
+  run(name, iterations, static_cast<long>(cmd.size()) - 1, 1, [&] {
+    parser.reset();
+    parser.parse(static_cast<int>(cmd.size()), cmd.data());
+  });
+}
+
+void bench_grammars() {
+  auto ls = make_ls_parser();
+  run_argv("grammar/ls", 200000, ls,
+           {"ls", "-la", "--color=always", "-D", "%F", "-G", "src", "include",
+            "tests"});
+
+  auto getopt = make_getopt_parser();
+  run_argv("grammar/getopt", 200000, getopt,
+           {"getopt", "-q", "-o", "hdrv", "-l", "help,debug,release,version",
+            "--", "-a", "-b", "-c", "-d", "-e"});
+
+  auto grep = make_grep_parser();
+  run_argv("grammar/grep", 200000, grep,
+           {"grep", "-rni", "yes", "--include=*.cpp", "--exclude-dir=build",
+            "-C", "3", "--color=auto", "-e", "argparse", "src", "include"});
+}
+
+// a parser with count long options, of which a command line sets 16; the
+// reset() of every run is linear in count as well
+void bench_option_count() {
+  for (int count : {10, 100, 1000, 10000}) {
+    argparse::ArgParser parser;
+    std::vector<std::string> args;
+    for (int i = 0; i < count; i++) {
+      auto const name = "option-" + std::to_string(i);
+      parser.add_option(name);
+      if (i % std::max(1, count / 16) == 0 && args.size() < 16) {
+        args.push_back("--" + name + "=value");
+      }
+    }
+    std::vector<const char*> cmd{"prog"};
+    for (auto const& arg : args) {
+      cmd.push_back(arg.c_str());
+    }
+    run_argv("option_count/" + std::to_string(count), 1000000 / count, parser,
+             cmd);
+  }
+}
+
+void bench_short_cluster() {
+  auto parser = make_ls_parser();
+  run_argv("short_cluster/ls", 200000, parser,
+           {"ls", "-abcdefghiklmnopqrstuvwxy1"});
+
+  // the same flags as bits of one word
+  std::uint64_t bits{0};
+  argparse::ArgParser packed;
+  std::size_t bit = 0;
+  for (auto const* flag : {"@", "A", "B", "C", "F", "H", "I", "L", "O", "P",
+                           "R", "S", "T", "U", "W", "a", "b", "c", "d", "e",
+                           "f", "g", "h", "i", "k", "l", "m", "n", "o", "p",
+                           "q", "r", "s", "t", "u", "v", "w", "x", "y", "%",
+                           "1"}) {
+    packed.add_flag(flag, bits, bit++);
+  }
+  run_argv("short_cluster/ls_bits", 200000, packed,
+           {"ls", "-abcdefghiklmnopqrstuvwxy1"});
+}
+
+void bench_key_value() {
+  auto parser = make_grep_parser();
+  run_argv("key_value/grep", 200000, parser,
+           {"grep", "--regexp=a", "--file=patterns", "--max-count=10",
+            "--label=stdin", "--binary-files=text", "--directories=skip",
+            "--devices=read", "--include=*.h", "--exclude=*.o",
+            "--exclude-dir=.git", "--before-context=1", "--after-context=2",
+            "--context=3", "--group-separator=--", "--color=never",
+            "--word-regexp=w"});
+}
+
+// 1000 values accumulated into a container option
+void bench_accumulate() {
+  std::vector<std::string> values;
+  for (int i = 0; i < 1000; i++) {
+    values.push_back("-n" + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"prog"};
+  for (auto const& value : values) {
+    cmd.push_back(value.c_str());
+  }
+  argparse::ArgParser vector_parser;
+  vector_parser.add_option<std::vector<int>>("n");
+  run_argv("accumulate/vector", 2000, vector_parser, cmd);
+
+  std::vector<std::string> pairs;
+  for (int i = 0; i < 1000; i++) {
+    pairs.push_back("-Dkey" + std::to_string(i) + "=" + std::to_string(i));
+  }
+  cmd = {"prog"};
+  for (auto const& pair : pairs) {
+    cmd.push_back(pair.c_str());
+  }
+  argparse::ArgParser map_parser;
+  map_parser.add_option<std::map<std::string, int>>("D");
+  run_argv("accumulate/map", 1000, map_parser, cmd);
+
+  // keys and values too long for the small string buffer
+  std::vector<std::string> properties;
+  for (int i = 0; i < 1000; i++) {
+    properties.push_back("-Dsome.long.property.key." + std::to_string(i) +
+                         "=some long property value " + std::to_string(i));
+  }
+  cmd = {"prog"};
+  for (auto const& property : properties) {
+    cmd.push_back(property.c_str());
+  }
+  argparse::ArgParser strings_parser;
+  strings_parser.add_option<std::map<std::string, std::string>>("D");
+  run_argv("accumulate/map_strings", 1000, strings_parser, cmd);
+
+  argparse::ArgParser unordered_parser;
+  unordered_parser.add_option<std::unordered_map<std::string, std::string>>(
+      "D");
+  run_argv("accumulate/unordered_map_strings", 1000, unordered_parser, cmd);
+
+  argparse::ArgParser views_parser;
+  views_parser
+      .add_option<std::unordered_map<std::string_view, std::string_view>>("D");
+  run_argv("accumulate/unordered_map_views", 1000, views_parser, cmd);
+}
+
+// --ids= with 100k comma separated integers; tokens are list elements here
+void bench_delimited_list() {
+  std::string ids = "--ids=";
+  for (int i = 0; i < 100000; i++) {
+    ids += (i == 0 ? "" : ",") + std::to_string(i * 7919);
+  }
+  std::vector<const char*> cmd{"prog", ids.c_str()};
+  argparse::ArgParser parser;
+  parser.add_option<std::vector<std::vector<int>>>("ids");
+  run("delimited_list/100000", 100, 100000, 1, [&] {
+    parser.reset();
+    parser.parse(static_cast<int>(cmd.size()), cmd.data());
+  });
+}
+
+void bench_many_positionals() {
+  auto parser = make_ls_parser();
+  std::vector<std::string> files;
+  for (int i = 0; i < 10000; i++) {
+    files.push_back("dir/file-" + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"ls", "-la"};
+  for (auto const& file : files) {
+    cmd.push_back(file.c_str());
+  }
+  run_argv("positionals/10000", 200, parser, cmd);
+}
+
+// 1000 occurrences of a numeric list option the program never reads,
+// converted during parse and deferred with lazy()
+void bench_lazy() {
+  std::vector<const char*> cmd{"prog"};
+  for (int i = 0; i < 1000; i++) {
+    cmd.push_back("--n=3.14159");
+  }
+  for (bool const lazy : {false, true}) {
+    argparse::ArgParser parser;
+    auto& n = parser.add_option<std::vector<double>>("n");
+    if (lazy) {
+      n.lazy();
+    }
+    run_argv(lazy ? "unread_option/lazy" : "unread_option/eager", 2000,
+             parser, cmd);
+  }
+}
+
+// reading a value after parse, by name and through a Handle
+void bench_value_access() {
+  auto parser = make_ls_parser();
+  argparse::Handle<bool> all = parser["a"];
+  std::vector<const char*> cmd{"ls", "-la"};
+  parser.parse(static_cast<int>(cmd.size()), cmd.data());
+  long hits = 0;
+  run("value_access/name", 2000000, 1, 0,
+      [&] { hits += static_cast<long>(parser["a"].get<bool>()); });
+  run("value_access/handle", 2000000, 1, 0,
+      [&] { hits += static_cast<long>(all.get()); });
+  // keep the reads from being optimized away
+  volatile long sink = hits;
+  (void)sink;
+}
+
+// 100k -Dkey=value entries collected into a std::map and into a FlatMap,
+// and every key of them looked up once; tokens are entries here
+void bench_flat_map() {
+  constexpr int count = 100000;
+  std::vector<std::string> entries;
+  std::vector<std::string> keys;
+  for (int i = 0; i < count; i++) {
+    keys.push_back("key." + std::to_string(i * 7919 % count));
+    entries.push_back("-D" + keys.back() + "=" + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"prog"};
+  for (auto const& entry : entries) {
+    cmd.push_back(entry.c_str());
+  }
+
+  std::map<std::string, int> map;
+  argparse::ArgParser map_parser;
+  map_parser.add_option("D", map);
+  run_argv("flat_map/parse/std_map", 10, map_parser, cmd);
+
+  argparse::FlatMap<std::string, int> flat_map;
+  argparse::ArgParser flat_parser;
+  flat_parser.add_option("D", flat_map);
+  run_argv("flat_map/parse/flat_map", 10, flat_parser, cmd);
+
+  long found = 0;
+  run("flat_map/lookup/std_map", 10, count, 0, [&] {
+    for (auto const& key : keys) {
+      found += map.find(key)->second;
+    }
+  });
+  run("flat_map/lookup/flat_map", 10, count, 0, [&] {
+    for (auto const& key : keys) {
+      found += flat_map.find(key)->second;
+    }
+  });
+  // keep the lookups from being optimized away
+  volatile long sink = found;
+  (void)sink;
+}
+
+// registering and compiling a grammar of 600 flags and options, the
+// startup cost of a large CLI; tokens are descriptors here
+void bench_startup() {
+  std::vector<std::string> flags;
+  std::vector<std::string> options;
+  for (int i = 0; i < 300; i++) {
+    auto const n = std::to_string(i);
+    flags.push_back("verbose-level-" + n + ", !no-verbose-level-" + n);
+    options.push_back("output-directory-" + n + ",output-dir-" + n);
+  }
+  run("startup/600", 200, 600, 0, [&] {
+    argparse::ArgParser parser;
+    for (int i = 0; i < 300; i++) {
+      parser.add_flag(flags[i]).help("print more or less");
+      parser.add_option(options[i]).help("write the results to DIR");
+    }
+    auto const spec = parser.freeze();
+    (void)spec;
+  });
+
+  // 200 int members of config structs, one add_option() each or one
+  // bind_struct() table per struct
+  std::array<Tunables, 20> tunables{};
+  std::vector<std::string> names;
+  for (int i = 0; i < 200; i++) {
+    names.push_back("tunable-" + std::to_string(i));
+  }
+  std::vector<std::vector<argparse::StructField<Tunables>>> tables;
+  for (std::size_t t = 0; t < tunables.size(); t++) {
+    tables.push_back(tunable_fields(&names[t * 10]));
+  }
+  run("startup/200/add_option", 1000, 200, 0, [&] {
+    argparse::ArgParser parser;
+    for (std::size_t t = 0; t < tunables.size(); t++) {
+      for (std::size_t m = 0; m < std::size(tunable_members); m++) {
+        parser.add_option(names[t * 10 + m], tunables[t].*tunable_members[m])
+            .help("a tunable");
+      }
+    }
+    parser.compile();
+  });
+  run("startup/200/bind_struct", 1000, 200, 0, [&] {
+    argparse::ArgParser parser;
+    for (std::size_t t = 0; t < tunables.size(); t++) {
+      parser.bind_struct(tunables[t], tables[t]);
+    }
+    parser.compile();
+  });
+}
+
+// 100k getopt command lines of mixed length, parsed with 1, 2, 4, ...
+// threads up to the hardware concurrency
+void bench_parse_batch() {
+  auto parser = make_getopt_parser();
+  auto const spec = parser.freeze();
+  std::vector<std::string> parameters;
+  for (int i = 0; i < 64; i++) {
+    parameters.push_back("parameter-" + std::to_string(i));
+  }
+  std::vector<std::vector<const char*>> argvs;
+  long tokens = 0;
+  for (int i = 0; i < 100000; i++) {
+    std::vector<const char*> cmd{"getopt", "-q", "-o", "hdrv", "--"};
+    for (int j = 0; j < (i * 7919) % 64; j++) {
+      cmd.push_back(parameters[j].c_str());
+    }
+    tokens += static_cast<long>(cmd.size()) - 1;
+    argvs.push_back(std::move(cmd));
+  }
+  auto const hardware = std::max(1U, std::thread::hardware_concurrency());
+  for (unsigned threads = 1;; threads *= 2) {
+    threads = std::min(threads, hardware);
+    run("parse_batch/getopt/threads=" + std::to_string(threads), 2, tokens,
+        static_cast<long>(argvs.size()), [&] {
+          auto results = spec.parse_batch(argvs, threads);
+          (void)results;
+        });
+    if (threads == hardware) {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    filter = argv[1];
+  }
+  std::printf(
+      "benchmark,iterations,ns_per_op,ns_per_token,tokens_per_s,argvs_per_s,"
+      "cycles_per_token\n");
+  bench_grammars();
+  bench_option_count();
+  bench_short_cluster();
+  bench_key_value();
+  bench_accumulate();
+  bench_delimited_list();
+  bench_many_positionals();
+  bench_lazy();
+  bench_value_access();
+  bench_flat_map();
+  bench_startup();
+  bench_parse_batch();
+  return 0;
+}
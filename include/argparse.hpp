@@ -21,21 +21,68 @@
 //     16. format help info
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cassert>
 #include <cctype>
 #include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARGPARSE_HAS_SSE2 1
+#endif
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+// Floating-point std::from_chars came late to libc++ and AppleClang; where
+// it is missing, numbers go through strtod_l() in the "C" locale instead.
+#ifndef ARGPARSE_HAS_FLOAT_FROM_CHARS
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define ARGPARSE_HAS_FLOAT_FROM_CHARS 1
+#else
+#define ARGPARSE_HAS_FLOAT_FROM_CHARS 0
+#endif
+#endif
+
+#if !ARGPARSE_HAS_FLOAT_FROM_CHARS
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+#endif
+
 namespace argparse {
 
 inline void UNREACHABLE() {
@@ -76,6 +123,108 @@ class positional_not_found : public std::exception {
   }
 };
 
+// A number of bytes, given with an optional decimal (K, M, G, T, P, E) or
+// binary (Ki, Mi, Gi, Ti, Pi, Ei) multiplier and an optional B, e.g. 512M,
+// 4KiB or 1048576. It converts to the std::uint64_t it holds.
+struct ByteSize {
+  std::uint64_t bytes{0};
+  constexpr operator std::uint64_t() const { return bytes; }
+};
+
+// The sorted vector of values behind FlatMap and FlatSet, ordered by the
+// key of each value and looked up with a binary search. push_back() only
+// appends, so that a parse collects all values of an option unsorted; the
+// parser restores the order once at the end of the parse with
+// sort_unique(), which keeps the first value of every key like the
+// std::map options do.
+template <typename Key, typename Value>
+class SortedVector {
+ public:
+  using key_type = Key;
+  using value_type = Value;
+  using const_iterator = typename std::vector<Value>::const_iterator;
+  using iterator = const_iterator;
+
+  SortedVector() = default;
+  SortedVector(std::initializer_list<Value> values) : items(values) {
+    sort_unique();
+  }
+
+  [[nodiscard]] const_iterator begin() const { return items.begin(); }
+  [[nodiscard]] const_iterator end() const { return items.end(); }
+  [[nodiscard]] std::size_t size() const { return items.size(); }
+  [[nodiscard]] bool empty() const { return items.empty(); }
+  void clear() { items.clear(); }
+  void reserve(std::size_t n) { items.reserve(n); }
+
+  template <typename K>
+  [[nodiscard]] const_iterator find(K const& key) const {
+    auto const it = std::lower_bound(
+        items.begin(), items.end(), key,
+        [](Value const& value, K const& k) { return key_of(value) < k; });
+    return it != items.end() && !(key < key_of(*it)) ? it : items.end();
+  }
+  template <typename K>
+  [[nodiscard]] std::size_t count(K const& key) const {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  void push_back(Value value) { items.push_back(std::move(value)); }
+  void sort_unique() {
+    auto const less = [](Value const& a, Value const& b) {
+      return key_of(a) < key_of(b);
+    };
+    std::stable_sort(items.begin(), items.end(), less);
+    items.erase(std::unique(items.begin(), items.end(),
+                            [&less](Value const& a, Value const& b) {
+                              return !less(a, b) && !less(b, a);
+                            }),
+                items.end());
+  }
+
+  friend bool operator==(SortedVector const& a, SortedVector const& b) {
+    return a.items == b.items;
+  }
+  friend bool operator!=(SortedVector const& a, SortedVector const& b) {
+    return !(a == b);
+  }
+
+ private:
+  static Key const& key_of(Value const& value) {
+    if constexpr (std::is_same_v<Key, Value>) {
+      return value;
+    } else {
+      return value.first;
+    }
+  }
+
+  std::vector<Value> items;
+};
+
+// a map in one contiguous vector sorted by key, see SortedVector
+template <typename K, typename V>
+class FlatMap : public SortedVector<K, std::pair<K, V>> {
+ public:
+  using mapped_type = V;
+  using SortedVector<K, std::pair<K, V>>::SortedVector;
+
+  template <typename Key>
+  V const& at(Key const& key) const {
+    auto const it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("argparse::FlatMap::at");
+    }
+    return it->second;
+  }
+};
+
+// a set in one contiguous sorted vector, see SortedVector
+template <typename K>
+class FlatSet : public SortedVector<K, K> {
+ public:
+  using SortedVector<K, K>::SortedVector;
+};
+
 template <typename T>
 struct is_reference_wrapper : std::false_type {};
 
@@ -103,9 +252,100 @@ template <typename T>
 struct is_map : std::false_type {};
 template <typename T, typename U>
 struct is_map<std::map<T, U>> : std::true_type {};
+template <typename T, typename U>
+struct is_map<std::unordered_map<T, U>> : std::true_type {};
 template <typename T>
 inline constexpr bool is_map_v = is_map<T>::value;
 
+template <typename T>
+struct is_flat_map : std::false_type {};
+template <typename T, typename U>
+struct is_flat_map<FlatMap<T, U>> : std::true_type {};
+template <typename T>
+struct is_flat_set : std::false_type {};
+template <typename T>
+struct is_flat_set<FlatSet<T>> : std::true_type {};
+// the containers which are sorted once at the end of a parse
+template <typename T>
+inline constexpr bool is_flat_v =
+    is_flat_map<T>::value || is_flat_set<T>::value;
+
+template <typename T>
+struct is_unordered_map : std::false_type {};
+template <typename T, typename U>
+struct is_unordered_map<std::unordered_map<T, U>> : std::true_type {};
+template <typename T>
+inline constexpr bool is_unordered_map_v = is_unordered_map<T>::value;
+
+// a std::chrono::duration counted in an integer
+template <typename T>
+struct is_duration : std::false_type {};
+template <typename Rep, typename Period>
+struct is_duration<std::chrono::duration<Rep, Period>> : std::is_integral<Rep> {
+};
+template <typename T>
+inline constexpr bool is_duration_v = is_duration<T>::value;
+
+// Specialized to name the values of an enum E, which makes E bindable:
+//
+//   namespace argparse {
+//   template <>
+//   struct enum_names<Color> {
+//     static constexpr Keyword<Color> values[] = {{"auto", Color::Auto},
+//                                                 {"always", Color::Always},
+//                                                 {"never", Color::Never}};
+//   };
+//   }  // namespace argparse
+//
+// values is any range of Keyword<E>, see EnumIndex.
+template <typename E>
+struct enum_names {};
+
+template <typename T, typename = void>
+struct is_enum_value : std::false_type {};
+template <typename T>
+struct is_enum_value<T, std::void_t<decltype(enum_names<T>::values)>>
+    : std::is_enum<T> {};
+template <typename T>
+inline constexpr bool is_enum_value_v = is_enum_value<T>::value;
+
+template <typename E>
+class EnumIndex;
+
+// Specialized to make any other type T bindable, converted straight from
+// the argument during the parse:
+//
+//   namespace argparse {
+//   template <>
+//   struct converter<Uuid> {
+//     // throws on an invalid value, preferably bad_value_access
+//     static void convert(std::string_view from, Uuid& to);
+//     // optional, the name in error messages
+//     static std::string name() { return "Uuid"; }
+//   };
+//   }  // namespace argparse
+//
+// T is then a scalar like int: it can be the element of a vector, the key
+// or value of a map and so on. It is kept in an ErasedValue, and has to be
+// default constructible and copyable. Types which are bindable already
+// keep their own conversion.
+template <typename T>
+struct converter {};
+
+template <typename T, typename = void>
+struct has_converter : std::false_type {};
+template <typename T>
+struct has_converter<T,
+                     std::void_t<decltype(converter<T>::convert(
+                         std::declval<std::string_view>(),
+                         std::declval<T&>()))>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_custom_value_v =
+    has_converter<T>::value && !std::is_arithmetic_v<T> &&
+    !std::is_same_v<std::string, T> && !std::is_same_v<std::string_view, T> &&
+    !std::is_same_v<ByteSize, T> && !is_duration_v<T> && !is_enum_value_v<T>;
+
 template <typename T>
 struct is_need_split : std::false_type {};
 template <typename T, typename U>
@@ -114,8 +354,20 @@ template <typename T, typename U>
 struct is_need_split<std::vector<std::pair<T, U>>> : std::true_type {};
 template <typename T, typename U>
 struct is_need_split<std::map<T, U>> : std::true_type {};
+template <typename T, typename U>
+struct is_need_split<std::unordered_map<T, U>> : std::true_type {};
+template <typename T, typename U>
+struct is_need_split<FlatMap<T, U>> : std::true_type {};
 template <typename T>
 struct is_need_split<std::vector<std::vector<T>>> : std::true_type {};
+template <typename T, std::size_t N>
+struct is_need_split<std::array<T, N>> : std::true_type {};
+template <typename... Ts>
+struct is_need_split<std::tuple<Ts...>> : std::true_type {};
+template <typename T, std::size_t N>
+struct is_need_split<std::vector<std::array<T, N>>> : std::true_type {};
+template <typename... Ts>
+struct is_need_split<std::vector<std::tuple<Ts...>>> : std::true_type {};
 template <typename T>
 inline constexpr bool is_need_split_v = is_need_split<T>::value;
 
@@ -124,27 +376,69 @@ struct default_delimiter : std::integral_constant<char, '='> {};
 template <typename T>
 struct default_delimiter<std::vector<std::vector<T>>>
     : std::integral_constant<char, ','> {};
+// --geometry=1920,1080
+template <typename T, std::size_t N>
+struct default_delimiter<std::array<T, N>>
+    : std::integral_constant<char, ','> {};
+template <typename... Ts>
+struct default_delimiter<std::tuple<Ts...>>
+    : std::integral_constant<char, ','> {};
+template <typename T, std::size_t N>
+struct default_delimiter<std::vector<std::array<T, N>>>
+    : std::integral_constant<char, ','> {};
+template <typename... Ts>
+struct default_delimiter<std::vector<std::tuple<Ts...>>>
+    : std::integral_constant<char, ','> {};
 template <typename T>
 inline constexpr char default_delimiter_v = default_delimiter<T>::value;
 
+// the scalars the value variant of an option is built from
+template <typename T>
+inline constexpr bool is_variant_scalar_v =
+    std::is_same_v<bool, T> || std::is_same_v<int, T> ||
+    std::is_same_v<double, T> || std::is_same_v<std::string, T>;
+
+// the scalars kept in an ErasedValue rather than in the variant
+template <typename T>
+inline constexpr bool is_erased_scalar_v =
+    !is_variant_scalar_v<T> &&
+    (std::is_same_v<std::int64_t, T> || std::is_same_v<std::uint64_t, T> ||
+     std::is_same_v<std::size_t, T> || std::is_same_v<float, T> ||
+     std::is_same_v<std::string_view, T> || std::is_same_v<ByteSize, T> ||
+     is_duration_v<T> || is_enum_value_v<T> || is_custom_value_v<T>);
+
+template <typename T>
+inline constexpr bool is_scalar_value_v =
+    is_variant_scalar_v<T> || is_erased_scalar_v<T>;
+
+// a std::array or std::tuple of scalars, one per delimiter separated part
+template <typename T>
+struct is_fixed_arity : std::false_type {};
+template <typename T, std::size_t N>
+struct is_fixed_arity<std::array<T, N>>
+    : std::bool_constant<N != 0 && is_scalar_value_v<T>> {};
+template <typename... Ts>
+struct is_fixed_arity<std::tuple<Ts...>>
+    : std::bool_constant<sizeof...(Ts) != 0 &&
+                         (is_scalar_value_v<Ts> && ...)> {};
+template <typename T>
+inline constexpr bool is_fixed_arity_v = is_fixed_arity<T>::value;
+
 template <typename T, typename = void>
 struct is_transformable_type : std::false_type {};
 
 template <typename T>
-struct is_transformable_type<
-    T,
-    std::enable_if_t<std::is_same_v<bool, T> || std::is_same_v<int, T> ||
-                     std::is_same_v<double, T> ||
-                     std::is_same_v<std::string, T>>> : std::true_type {};
+struct is_transformable_type<T, std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
 
 template <typename T, typename U>
 struct is_transformable_type<
     std::pair<T, U>,
-    std::enable_if_t<
-        (std::is_same_v<bool, T> || std::is_same_v<int, T> ||
-         std::is_same_v<double, T> || std::is_same_v<std::string, T>) &&
-        (std::is_same_v<bool, U> || std::is_same_v<int, U> ||
-         std::is_same_v<double, U> || std::is_same_v<std::string, U>)>>
+    std::enable_if_t<is_scalar_value_v<T> && is_scalar_value_v<U>>>
+    : std::true_type {};
+
+template <typename T>
+struct is_transformable_type<T, std::enable_if_t<is_fixed_arity_v<T>>>
     : std::true_type {};
 
 template <typename T>
@@ -163,6 +457,23 @@ template <typename T>
 inline constexpr bool is_flag_bindable_value_v =
     is_flag_bindable_value<T>::value;
 
+// the number of flags a word can hold one bit each of, 0 if it is no word
+template <typename T, typename = void>
+struct flag_word_bits : std::integral_constant<std::size_t, 0> {};
+
+template <typename T>
+struct flag_word_bits<
+    T,
+    std::enable_if_t<std::is_unsigned_v<T> && !std::is_same_v<bool, T>>>
+    : std::integral_constant<std::size_t, std::numeric_limits<T>::digits> {};
+
+template <std::size_t N>
+struct flag_word_bits<std::bitset<N>> : std::integral_constant<std::size_t, N> {
+};
+
+template <typename T>
+inline constexpr bool is_flag_word_v = flag_word_bits<T>::value > 0;
+
 template <typename T, typename = void>
 struct is_option_bindable_value : std::false_type {};
 
@@ -175,12 +486,35 @@ struct is_option_bindable_value<std::vector<T>,
                                 std::enable_if_t<is_transformable_type_v<T>>>
     : std::true_type {};
 
+// one delimited list per occurrence, --ids=1,2,3
+template <typename T>
+struct is_option_bindable_value<std::vector<std::vector<T>>,
+                                std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
 template <typename T, typename U>
 struct is_option_bindable_value<
     std::map<T, U>,
     std::enable_if_t<is_transformable_type_v<T> && is_transformable_type_v<U>>>
     : std::true_type {};
 
+template <typename T, typename U>
+struct is_option_bindable_value<
+    std::unordered_map<T, U>,
+    std::enable_if_t<is_scalar_value_v<T> && is_transformable_type_v<U>>>
+    : std::true_type {};
+
+template <typename T, typename U>
+struct is_option_bindable_value<
+    FlatMap<T, U>,
+    std::enable_if_t<is_scalar_value_v<T> && is_transformable_type_v<U>>>
+    : std::true_type {};
+
+template <typename T>
+struct is_option_bindable_value<FlatSet<T>,
+                                std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
 template <typename T>
 inline constexpr bool is_option_bindable_value_v =
     is_option_bindable_value<T>::value;
@@ -207,6 +541,23 @@ inline constexpr bool is_bindable_value_v =
     is_flag_bindable_value_v<T> || is_option_bindable_value_v<T> ||
     is_position_bindable_value_v<T>;
 
+// What an option value is shown as in the usage without a value_help(). An
+// enum shows its names, which builds its EnumIndex as the option is made.
+template <typename T>
+std::string_view default_value_help() {
+  if constexpr (is_vector_v<T>) {
+    return default_value_help<typename T::value_type>();
+  } else if constexpr (is_enum_value_v<T>) {
+    return EnumIndex<T>::instance().candidates();
+  } else if constexpr (std::is_same_v<ByteSize, T>) {
+    return "SIZE";
+  } else if constexpr (is_duration_v<T>) {
+    return "DURATION";
+  } else {
+    return "TEXT";
+  }
+}
+
 // overloaded
 template <typename... T>
 struct overloaded : public T... {
@@ -225,11 +576,31 @@ struct is_option_bindable_container<
     std::vector<T>,
     std::enable_if_t<is_transformable_type_v<T>>> : std::true_type {};
 
+template <typename T>
+struct is_option_bindable_container<std::vector<std::vector<T>>,
+                                    std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
 template <typename T, typename U>
 struct is_option_bindable_container<
     std::map<T, U>,
     std::enable_if_t<is_transformable_type_v<T>>> : std::true_type {};
 
+template <typename T, typename U>
+struct is_option_bindable_container<std::unordered_map<T, U>,
+                                    std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
+template <typename T, typename U>
+struct is_option_bindable_container<FlatMap<T, U>,
+                                    std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
+template <typename T>
+struct is_option_bindable_container<FlatSet<T>,
+                                    std::enable_if_t<is_scalar_value_v<T>>>
+    : std::true_type {};
+
 template <typename T>
 constexpr bool is_option_bindable_container_v =
     is_option_bindable_container<T>::value;
@@ -273,7 +644,23 @@ struct make_variant_type {
       type5>::type;
 };
 
-template <typename T>
+template <typename V, typename T>
+struct variant_push_back;
+template <typename... Ts, typename T>
+struct variant_push_back<std::variant<Ts...>, T> {
+  using type = std::variant<Ts..., T>;
+};
+
+template <typename T, typename V>
+struct is_variant_alternative : std::false_type {};
+template <typename T, typename... Ts>
+struct is_variant_alternative<T, std::variant<Ts...>>
+    : std::disjunction<std::is_same<T, Ts>...> {};
+template <typename T, typename V>
+inline constexpr bool is_variant_alternative_v =
+    is_variant_alternative<T, V>::value;
+
+template <typename T, typename = void>
 struct bindable_type_info;
 
 template <>
@@ -285,6 +672,26 @@ struct bindable_type_info<int> {
   inline static std::string name() { return "int"; }
 };
 template <>
+struct bindable_type_info<std::int64_t> {
+  inline static std::string name() { return "std::int64_t"; }
+};
+template <>
+struct bindable_type_info<std::uint64_t> {
+  inline static std::string name() { return "std::uint64_t"; }
+};
+// only where std::size_t is not std::uint64_t already
+template <typename T>
+struct bindable_type_info<
+    T,
+    std::enable_if_t<std::is_same_v<std::size_t, T> &&
+                     !std::is_same_v<std::size_t, std::uint64_t>>> {
+  inline static std::string name() { return "std::size_t"; }
+};
+template <>
+struct bindable_type_info<float> {
+  inline static std::string name() { return "float"; }
+};
+template <>
 struct bindable_type_info<double> {
   inline static std::string name() { return "double"; }
 };
@@ -292,6 +699,58 @@ template <>
 struct bindable_type_info<std::string> {
   inline static std::string name() { return "std::string"; }
 };
+template <>
+struct bindable_type_info<std::string_view> {
+  inline static std::string name() { return "std::string_view"; }
+};
+template <>
+struct bindable_type_info<ByteSize> {
+  inline static std::string name() { return "argparse::ByteSize"; }
+};
+template <typename T, typename = void>
+struct has_converter_name : std::false_type {};
+template <typename T>
+struct has_converter_name<T, std::void_t<decltype(converter<T>::name())>>
+    : std::true_type {};
+
+template <typename T>
+struct bindable_type_info<T, std::enable_if_t<is_custom_value_v<T>>> {
+  inline static std::string name() {
+    if constexpr (has_converter_name<T>::value) {
+      return std::string(converter<T>::name());
+    } else {
+      return "argparse::converter<T>";
+    }
+  }
+};
+template <typename T>
+struct bindable_type_info<T, std::enable_if_t<is_enum_value_v<T>>> {
+  inline static std::string name() {
+    return "enum{" + EnumIndex<T>::instance().candidates() + "}";
+  }
+};
+template <typename Rep, typename Period>
+struct bindable_type_info<std::chrono::duration<Rep, Period>> {
+  inline static std::string name() {
+    using type = std::chrono::duration<Rep, Period>;
+    if constexpr (std::is_same_v<std::chrono::nanoseconds, type>) {
+      return "std::chrono::nanoseconds";
+    } else if constexpr (std::is_same_v<std::chrono::microseconds, type>) {
+      return "std::chrono::microseconds";
+    } else if constexpr (std::is_same_v<std::chrono::milliseconds, type>) {
+      return "std::chrono::milliseconds";
+    } else if constexpr (std::is_same_v<std::chrono::seconds, type>) {
+      return "std::chrono::seconds";
+    } else if constexpr (std::is_same_v<std::chrono::minutes, type>) {
+      return "std::chrono::minutes";
+    } else if constexpr (std::is_same_v<std::chrono::hours, type>) {
+      return "std::chrono::hours";
+    } else {
+      return "std::chrono::duration<" + std::to_string(Period::num) + "/" +
+             std::to_string(Period::den) + ">";
+    }
+  }
+};
 
 template <typename T, typename U>
 struct bindable_type_info<std::pair<T, U>> {
@@ -307,6 +766,42 @@ struct bindable_type_info<std::map<T, U>> {
            bindable_type_info<U>::name() + ">";
   }
 };
+template <typename T, typename U>
+struct bindable_type_info<FlatMap<T, U>> {
+  inline static std::string name() {
+    return std::string("argparse::FlatMap<") + bindable_type_info<T>::name() +
+           "," + bindable_type_info<U>::name() + ">";
+  }
+};
+template <typename T>
+struct bindable_type_info<FlatSet<T>> {
+  inline static std::string name() {
+    return std::string("argparse::FlatSet<") + bindable_type_info<T>::name() +
+           ">";
+  }
+};
+template <typename T, typename U>
+struct bindable_type_info<std::unordered_map<T, U>> {
+  inline static std::string name() {
+    return std::string("std::unordered_map<") + bindable_type_info<T>::name() +
+           "," + bindable_type_info<U>::name() + ">";
+  }
+};
+
+template <typename T, std::size_t N>
+struct bindable_type_info<std::array<T, N>> {
+  inline static std::string name() {
+    return std::string("std::array<") + bindable_type_info<T>::name() + "," +
+           std::to_string(N) + ">";
+  }
+};
+template <typename T, typename... Ts>
+struct bindable_type_info<std::tuple<T, Ts...>> {
+  inline static std::string name() {
+    return std::string("std::tuple<") + bindable_type_info<T>::name() +
+           (("," + bindable_type_info<Ts>::name()) + ... + "") + ">";
+  }
+};
 
 template <typename T>
 struct bindable_type_info<std::vector<T>> {
@@ -317,157 +812,955 @@ struct bindable_type_info<std::vector<T>> {
 
 //**********************************
 namespace StringUtil {
-inline bool startswith(std::string const& str, std::string const& prefix) {
-  if (str.length() < prefix.length()) {
+inline bool startswith(std::string_view str, std::string_view prefix) {
+  return str.substr(0, prefix.size()) == prefix;
+}
+
+// Calls f with each part of s between delimiters, views into s. Like
+// getline() an empty part after the last delimiter is dropped. With
+// number > 0 at most number parts are split off and the rest is the last
+// part.
+template <typename F>
+void for_each_part(std::string_view s, char delimiter, F&& f, int number = 0) {
+  int splitCount = 0;
+  std::size_t pos = 0;
+  while (pos < s.size()) {
+    auto const end = number > 0 && splitCount == number
+                         ? std::string_view::npos
+                         : s.find(delimiter, pos);
+    if (end == std::string_view::npos) {
+      f(s.substr(pos));
+      return;
+    }
+    f(s.substr(pos, end - pos));
+    pos = end + 1;
+    splitCount++;
+  }
+}
+
+inline std::vector<std::string_view> split(std::string_view s,
+                                           char delimiter,
+                                           int number = 0) {
+  std::vector<std::string_view> result;
+  for_each_part(
+      s, delimiter,
+      [&result](std::string_view part) { result.push_back(part); }, number);
+  return result;
+}
+
+inline std::string_view trim(std::string_view s) {
+  auto const is_space = [](char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+  };
+  while (!s.empty() && is_space(s.front())) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && is_space(s.back())) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// the name without its leading "--" or "-"
+inline std::string_view strip_dashes(std::string_view name) {
+  if (startswith(name, "--")) {
+    return name.substr(2);
+  }
+  if (startswith(name, "-")) {
+    return name.substr(1);
+  }
+  return name;
+}
+
+inline char to_lower_ascii(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// compares ignoring ASCII case, independent of the locale
+inline bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
     return false;
   }
-  auto it = str.begin();
-  auto pit = prefix.begin();
-  while (pit != prefix.end()) {
-    if (*it != *pit) {
+  for (std::size_t i = 0; i < a.size(); i++) {
+    if (to_lower_ascii(a[i]) != to_lower_ascii(b[i])) {
       return false;
     }
-    it++;
-    pit++;
   }
   return true;
 }
-inline std::vector<std::string> split(std::string const& s,
-                                      char delimiter,
-                                      int number = 0) {
-  std::vector<std::string> result;
-  std::istringstream ss{s};
-  std::string token;
-  int splitCount = 0;
-  while ((number <= 0 || splitCount++ < number) &&
-         getline(ss, token, delimiter)) {
-    result.push_back(token);
-    if (number > 0 && splitCount == number) {
-      getline(ss, token);
-      result.push_back(token);
+
+// a < b ignoring ASCII case, independent of the locale
+inline bool iless(std::string_view a, std::string_view b) {
+  auto const n = std::min(a.size(), b.size());
+  for (std::size_t i = 0; i < n; i++) {
+    auto const ca = to_lower_ascii(a[i]);
+    auto const cb = to_lower_ascii(b[i]);
+    if (ca != cb) {
+      return static_cast<unsigned char>(ca) < static_cast<unsigned char>(cb);
     }
   }
-  return result;
+  return a.size() < b.size();
+}
+
+// Counts c in str, 16 bytes per step where SSE2 is available.
+inline std::size_t count(std::string_view str, char c) {
+  std::size_t n = 0;
+  std::size_t i = 0;
+#ifdef ARGPARSE_HAS_SSE2
+  auto const needle = _mm_set1_epi8(c);
+  for (; i + 16 <= str.size(); i += 16) {
+    auto const block =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(str.data() + i));
+    auto mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+    for (; mask != 0; mask &= mask - 1) {
+      n++;
+    }
+  }
+#endif
+  for (; i < str.size(); i++) {
+    n += static_cast<std::size_t>(str[i] == c);
+  }
+  return n;
 }
 
-inline bool is_short_opt(std::string const& opt) {
+inline bool is_short_opt(std::string_view opt) {
   return opt.size() >= 2 && opt[0] == '-' && opt[1] != '-';
 }
-inline bool is_long_opt(std::string const& opt) {
+inline bool is_long_opt(std::string_view opt) {
   return opt.size() >= 3 && opt[0] == '-' && opt[1] == '-' && opt[2] != '-';
 }
-inline bool is_dash_dash(std::string const& opt) {
+inline bool is_dash_dash(std::string_view opt) {
   return opt == "--";
 }
-inline bool is_position_arg(std::string const& str) {
+inline bool is_position_arg(std::string_view str) {
   return !is_short_opt(str) && !is_long_opt(str) && !is_dash_dash(str);
 }
 }  // namespace StringUtil
 
+// A word a value can be spelled as, see find_keyword().
+template <typename T>
+struct Keyword {
+  std::string_view name;
+  T value;
+};
+
+// Returns the value of the keyword which equals str ignoring ASCII case,
+// nullptr if none does. keywords is any range of Keyword<T>, a table is
+// searched in order and nothing is allocated.
+template <typename Keywords>
+auto find_keyword(std::string_view str, Keywords const& keywords)
+    -> decltype(&std::begin(keywords)->value) {
+  for (auto const& keyword : keywords) {
+    if (StringUtil::iequals(str, keyword.name)) {
+      return &keyword.value;
+    }
+  }
+  return nullptr;
+}
+
+inline constexpr Keyword<bool> bool_keywords[] = {
+    {"true", true}, {"false", false}, {"yes", true}, {"no", false},
+    {"on", true},   {"off", false},   {"1", true},   {"0", false}};
+
 // bool
 template <typename T, std::enable_if_t<std::is_same_v<bool, T>, bool> = true>
-void transform_value(std::string const& from, T& to) {
-  std::string lower_from;
-  std::transform(from.begin(), from.end(), std::back_inserter(lower_from),
-                 [](unsigned char c) { return std::tolower(c); });
-  if (lower_from == "true") {
-    to = true;
-  } else if (lower_from == "false") {
-    to = false;
+void transform_value(std::string_view from, T& to) {
+  if (auto const* value = find_keyword(from, bool_keywords)) {
+    to = *value;
   } else {
-    throw bad_value_access(std::string("err: ") + "'" + from + "'" + " => " +
-                           bindable_type_info<T>::name());
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name());
   }
 }
 
-template <typename T,
-          std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<bool, T>,
-                           bool> = true>
-void transform_value(std::string const& from, T& to) {
-  auto [ptr, ec] = std::from_chars(from.data(), from.data() + from.size(), to);
-  if (ec == std::errc::invalid_argument || ec != std::errc{}) {
-    throw bad_value_access(std::string("err: ") + "'" + from + "'" + " => " +
-                           bindable_type_info<T>::name());
+// The names of enum_names<E>::values sorted ignoring ASCII case, built once
+// per enum, so a value is looked up with a binary search whatever the
+// number of names. Two names which only differ in case are a logic_error.
+template <typename E>
+class EnumIndex {
+ public:
+  static EnumIndex const& instance() {
+    static EnumIndex const index;
+    return index;
+  }
+
+  // the value named str ignoring ASCII case, nullptr if there is none
+  E const* find(std::string_view str) const {
+    auto const it = std::lower_bound(
+        sorted.begin(), sorted.end(), str,
+        [](Keyword<E> const& keyword, std::string_view name) {
+          return StringUtil::iless(keyword.name, name);
+        });
+    if (it == sorted.end() || !StringUtil::iequals(it->name, str)) {
+      return nullptr;
+    }
+    return &it->value;
   }
-}
 
-template <typename T, std::enable_if_t<std::is_same_v<double, T>, bool> = true>
-void transform_value(std::string const& from, T& to) {
-  try {
-    to = std::stod(from, nullptr);
-  } catch (std::invalid_argument const& e) {
-    throw bad_value_access(std::string(e.what()) + ": '" + from + "'" + " => " +
-                           bindable_type_info<T>::name());
+  // all names in their declared order, "auto|always|never"
+  std::string const& candidates() const { return names; }
+
+ private:
+  EnumIndex() {
+    for (auto const& keyword : enum_names<E>::values) {
+      sorted.push_back(Keyword<E>{keyword.name, keyword.value});
+      names.append(names.empty() ? "" : "|").append(keyword.name);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](Keyword<E> const& a, Keyword<E> const& b) {
+                return StringUtil::iless(a.name, b.name);
+              });
+    auto const duplicate = std::adjacent_find(
+        sorted.begin(), sorted.end(),
+        [](Keyword<E> const& a, Keyword<E> const& b) {
+          return StringUtil::iequals(a.name, b.name);
+        });
+    if (duplicate != sorted.end()) {
+      throw std::logic_error("enum name already exists: " +
+                             std::string(duplicate->name));
+    }
   }
-}
 
-// std::string
-template <typename T,
-          std::enable_if_t<std::is_same_v<std::string, T>, bool> = true>
-void transform_value(std::string const& from, T& to) {
-  to = from;
-}
+  std::vector<Keyword<E>> sorted;
+  std::string names;
+};
 
-template <typename T, std::enable_if_t<is_pair_v<T>, bool> = true>
-void transform_value(std::string const& from, T& to, char delimiter = '=') {
-  auto index = from.find(delimiter);
-  if (index != std::string::npos) {
-    transform_value(from.substr(0, index), to.first);
-    transform_value(from.substr(index + 1), to.second);
+// enums with enum_names
+template <typename T, std::enable_if_t<is_enum_value_v<T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  auto const& index = EnumIndex<T>::instance();
+  if (auto const* value = index.find(from)) {
+    to = *value;
+  } else {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " is not one of " + index.candidates());
   }
 }
 
-// container
-template <typename T,
-          std::enable_if_t<is_option_bindable_container_v<T>, bool> = true>
-void insert_or_replace_value(T& bind_value,
-                             std::string const& option_val,
-                             char delimiter = '=') {
-  if (option_val.empty()) {
-    return;
-  }
-  std::insert_iterator<T> it(bind_value, bind_value.end());  // insert to end
-  if constexpr (is_pair_v<typename T::value_type>) {
-    using writable_pair = typename std::pair<
-        typename std::remove_const_t<typename T::value_type::first_type>,
-        typename T::value_type::second_type>;
-    writable_pair result;
-    transform_value<writable_pair>(option_val, result, delimiter);
-    *it = std::move(result);
+#if !ARGPARSE_HAS_FLOAT_FROM_CHARS
+// std::from_chars for floating points on top of strtod_l() in the "C"
+// locale. Matches its contract: no leading whitespace or '+', "0x" stops
+// after the '0', ERANGE is result_out_of_range and ptr is one past the last
+// character used, so callers keep checking for full consumption.
+template <typename T>
+std::from_chars_result from_chars_float(char const* first,
+                                        char const* last,
+                                        T& to) {
+  char const* const digits = first + (first != last && *first == '-');
+  if (digits == last || *digits == '+' ||
+      std::isspace(static_cast<unsigned char>(*digits))) {
+    return {first, std::errc::invalid_argument};
+  }
+  if (last - digits > 1 && digits[0] == '0' &&
+      (digits[1] == 'x' || digits[1] == 'X')) {
+    to = digits == first ? T(0) : -T(0);
+    return {digits + 1, std::errc{}};
+  }
+
+  // strtod_l() wants a NUL-terminated string
+  char stack[64];
+  std::string heap;
+  char* copy = stack;
+  auto const size = static_cast<std::size_t>(last - first);
+  if (size < sizeof(stack)) {
+    std::memcpy(stack, first, size);
+    stack[size] = '\0';
+  } else {
+    heap.assign(first, last);
+    copy = heap.data();
+  }
+
+  static locale_t const c_locale = newlocale(LC_ALL_MASK, "C", locale_t{});
+  int const saved_errno = errno;
+  errno = 0;
+  char* end = nullptr;
+  T value;
+  if constexpr (std::is_same_v<T, float>) {
+    value = strtof_l(copy, &end, c_locale);
+  } else if constexpr (std::is_same_v<T, double>) {
+    value = strtod_l(copy, &end, c_locale);
   } else {
-    typename T::value_type result;
-    transform_value<typename T::value_type>(option_val, result);
-    *it = std::move(result);
+    value = strtold_l(copy, &end, c_locale);
   }
-}
+  bool const out_of_range = errno == ERANGE;
+  errno = saved_errno;
 
-// non-container
-template <typename T,
-          std::enable_if_t<!is_option_bindable_container_v<T>, bool> = false>
-void insert_or_replace_value(T& bind_value,
-                             std::string const& option_val,
-                             char delimiter = '=') {
-  if (option_val.empty()) {
-    return;
+  if (end == copy) {
+    return {first, std::errc::invalid_argument};
   }
-  T result;
-  if constexpr (is_pair_v<T>) {
-    transform_value<T>(option_val, result, delimiter);
-  } else {
-    transform_value<T>(option_val, result);
+  char const* const ptr = first + (end - copy);
+  if (out_of_range) {
+    return {ptr, std::errc::result_out_of_range};
   }
-  bind_value = std::move(result);
+  to = value;
+  return {ptr, std::errc{}};
 }
+#endif
 
-class OptBase {
-  friend class ArgParser;
+// std::from_chars, which also accepts a leading '+' like strtod() does
+template <typename T>
+std::from_chars_result from_chars_signed(char const* first,
+                                         char const* last,
+                                         T& to) {
+  if (last - first > 1 && first[0] == '+' && first[1] != '-') {
+    first++;
+  }
+#if !ARGPARSE_HAS_FLOAT_FROM_CHARS
+  if constexpr (std::is_floating_point_v<T>) {
+    return from_chars_float(first, last, to);
+  }
+#endif
+  return std::from_chars(first, last, to);
+}
 
- protected:
+// Converts all of from to a number with std::from_chars, which neither
+// depends on the locale nor allocates. Any character left over is an
+// error. to is only written on success.
+template <typename T>
+std::errc from_chars_all(std::string_view from, T& to) {
+  auto const* const last = from.data() + from.size();
+  T value{};
+  auto const [ptr, ec] = from_chars_signed(from.data(), last, value);
+  if (ec != std::errc{}) {
+    return ec;
+  }
+  if (ptr != last) {
+    return std::errc::invalid_argument;
+  }
+  to = value;
+  return ec;
+}
+
+// integers and floating points
+template <typename T,
+          std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<bool, T>,
+                           bool> = true>
+void transform_value(std::string_view from, T& to) {
+  if (from_chars_all(from, to) != std::errc{}) {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name());
+  }
+}
+
+// std::string_view, a view of the argument in the caller's argv, which
+// must outlive the value; the value of an alias flag views the parser.
+template <typename T,
+          std::enable_if_t<std::is_same_v<std::string_view, T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  to = from;
+}
+
+// types with a converter, whose errors are reported as bad_value_access
+template <typename T, std::enable_if_t<is_custom_value_v<T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  try {
+    converter<T>::convert(from, to);
+  } catch (bad_value_access const&) {
+    throw;
+  } catch (std::exception const& e) {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name() +
+                           ": " + e.what());
+  }
+}
+
+// the multipliers of a ByteSize, a bare number counts bytes
+inline constexpr Keyword<std::uint64_t> byte_size_suffixes[] = {
+    {"", 1},
+    {"B", 1},
+    {"K", 1000},
+    {"KB", 1000},
+    {"Ki", std::uint64_t{1} << 10U},
+    {"KiB", std::uint64_t{1} << 10U},
+    {"M", 1000 * 1000},
+    {"MB", 1000 * 1000},
+    {"Mi", std::uint64_t{1} << 20U},
+    {"MiB", std::uint64_t{1} << 20U},
+    {"G", 1000 * 1000 * 1000},
+    {"GB", 1000 * 1000 * 1000},
+    {"Gi", std::uint64_t{1} << 30U},
+    {"GiB", std::uint64_t{1} << 30U},
+    {"T", 1000ULL * 1000 * 1000 * 1000},
+    {"TB", 1000ULL * 1000 * 1000 * 1000},
+    {"Ti", std::uint64_t{1} << 40U},
+    {"TiB", std::uint64_t{1} << 40U},
+    {"P", 1000ULL * 1000 * 1000 * 1000 * 1000},
+    {"PB", 1000ULL * 1000 * 1000 * 1000 * 1000},
+    {"Pi", std::uint64_t{1} << 50U},
+    {"PiB", std::uint64_t{1} << 50U},
+    {"E", 1000ULL * 1000 * 1000 * 1000 * 1000 * 1000},
+    {"EB", 1000ULL * 1000 * 1000 * 1000 * 1000 * 1000},
+    {"Ei", std::uint64_t{1} << 60U},
+    {"EiB", std::uint64_t{1} << 60U}};
+
+// ByteSize, a size which does not fit into 64 bits is an error
+template <typename T,
+          std::enable_if_t<std::is_same_v<ByteSize, T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  auto const* const last = from.data() + from.size();
+  std::uint64_t count{0};
+  auto const [ptr, ec] = from_chars_signed(from.data(), last, count);
+  std::uint64_t const* multiplier = nullptr;
+  if (ec == std::errc{}) {
+    multiplier = find_keyword(
+        std::string_view(ptr, static_cast<std::size_t>(last - ptr)),
+        byte_size_suffixes);
+  }
+  if (multiplier == nullptr ||
+      count > std::numeric_limits<std::uint64_t>::max() / *multiplier) {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name());
+  }
+  to.bytes = count * *multiplier;
+}
+
+// one unit of a duration in seconds, num / den
+struct DurationUnit {
+  std::intmax_t num;
+  std::intmax_t den;
+};
+
+inline constexpr Keyword<DurationUnit> duration_units[] = {
+    {"ns", {1, 1000 * 1000 * 1000}},
+    {"us", {1, 1000 * 1000}},
+    {"ms", {1, 1000}},
+    {"s", {1, 1}},
+    {"m", {60, 1}},
+    {"min", {60, 1}},
+    {"h", {60 * 60, 1}},
+    {"d", {24 * 60 * 60, 1}}};
+
+// a * b, false if that does not fit into std::intmax_t
+inline bool multiply_checked(std::intmax_t a,
+                             std::intmax_t b,
+                             std::intmax_t& to) {
+  constexpr auto max = std::numeric_limits<std::intmax_t>::max();
+  constexpr auto min = std::numeric_limits<std::intmax_t>::min();
+  if (a != 0 && b != 0) {
+    if (a > 0 ? (b > 0 ? a > max / b : b < min / a)
+              : (b > 0 ? a < min / b : b < max / a)) {
+      return false;
+    }
+  }
+  to = a * b;
+  return true;
+}
+
+// std::chrono::duration, 250ms or 1h; a bare number counts ticks of T. A
+// value which T can not hold exactly, like 1500ms for std::chrono::seconds,
+// is an error rather than being truncated.
+template <typename T, std::enable_if_t<is_duration_v<T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  using period = typename T::period;
+  using rep = typename T::rep;
+  auto const* const last = from.data() + from.size();
+  std::intmax_t count{0};
+  auto const [ptr, ec] = from_chars_signed(from.data(), last, count);
+  DurationUnit unit{period::num, period::den};
+  bool ok = ec == std::errc{};
+  if (ok && ptr != last) {
+    auto const* found = find_keyword(
+        std::string_view(ptr, static_cast<std::size_t>(last - ptr)),
+        duration_units);
+    ok = found != nullptr;
+    unit = ok ? *found : unit;
+  }
+  // the unit in ticks of T is num / den
+  auto const g1 = std::gcd(unit.num, std::intmax_t{period::num});
+  auto const g2 = std::gcd(unit.den, std::intmax_t{period::den});
+  std::intmax_t num{0};
+  std::intmax_t den{0};
+  std::intmax_t ticks{0};
+  ok = ok && multiply_checked(unit.num / g1, period::den / g2, num) &&
+       multiply_checked(unit.den / g2, period::num / g1, den) &&
+       multiply_checked(count, num, ticks) && ticks % den == 0;
+  ticks = ok ? ticks / den : 0;
+  if (!ok || ticks < std::intmax_t{std::numeric_limits<rep>::min()} ||
+      (ticks > 0 &&
+       static_cast<std::uintmax_t>(ticks) >
+           static_cast<std::uintmax_t>(std::numeric_limits<rep>::max()))) {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name());
+  }
+  to = T(static_cast<rep>(ticks));
+}
+
+// std::string
+template <typename T,
+          std::enable_if_t<std::is_same_v<std::string, T>, bool> = true>
+void transform_value(std::string_view from, T& to) {
+  to.assign(from.data(), from.size());
+}
+
+template <typename T, std::enable_if_t<is_pair_v<T>, bool> = true>
+void transform_value(std::string_view from, T& to, char delimiter = '=') {
+  auto index = from.find(delimiter);
+  if (index != std::string_view::npos) {
+    transform_value(from.substr(0, index), to.first);
+    transform_value(from.substr(index + 1), to.second);
+  }
+}
+
+template <typename T, std::size_t... I>
+void transform_elements(
+    std::array<std::string_view, sizeof...(I)> const& parts,
+    T& to,
+    std::index_sequence<I...> /*unused*/) {
+  (transform_value(parts[I], std::get<I>(to)), ...);
+}
+
+// std::array and std::tuple, one element per delimiter separated part. A
+// different number of parts is an error; to is only written when every
+// element converted.
+template <typename T, std::enable_if_t<is_fixed_arity_v<T>, bool> = true>
+void transform_value(std::string_view from, T& to, char delimiter = ',') {
+  constexpr auto arity = std::tuple_size_v<T>;
+  std::array<std::string_view, arity> parts{};
+  std::size_t found = 0;
+  std::size_t pos = 0;
+  for (;;) {
+    auto const end = from.find(delimiter, pos);
+    if (found < arity) {
+      parts[found] = from.substr(
+          pos, end == std::string_view::npos ? end : end - pos);
+    }
+    found++;
+    if (end == std::string_view::npos) {
+      break;
+    }
+    pos = end + 1;
+  }
+  if (found != arity) {
+    throw bad_value_access(std::string("err: ") + "'" + std::string(from) +
+                           "'" + " => " + bindable_type_info<T>::name() +
+                           ", expected " + std::to_string(arity) +
+                           " values separated by '" +
+                           std::string(1, delimiter) + "'");
+  }
+  T value{};
+  transform_elements(parts, value, std::make_index_sequence<arity>{});
+  to = std::move(value);
+}
+
+// Appends the delimiter separated elements of from to to, reserved for all
+// of them up front. Elements are split like StringUtil::split(): a doubled
+// delimiter makes an empty element, which only a string accepts, and a
+// trailing delimiter ends the list. A number is converted straight from
+// from and must end at a delimiter, other elements are found with memchr;
+// numeric elements allocate nothing.
+template <typename T>
+void transform_list(std::string_view from,
+                    std::vector<T>& to,
+                    char delimiter) {
+  to.reserve(to.size() + StringUtil::count(from, delimiter) + 1);
+  auto const* first = from.data();
+  auto const* const last = first + from.size();
+  if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<bool, T>) {
+    while (first != last) {
+      T value{};
+      auto const [ptr, ec] = from_chars_signed(first, last, value);
+      if (ec != std::errc{} || (ptr != last && *ptr != delimiter)) {
+        auto const* end = static_cast<char const*>(std::memchr(
+            first, delimiter, static_cast<std::size_t>(last - first)));
+        throw bad_value_access(
+            std::string("err: ") + "'" +
+            std::string(first, end == nullptr ? last : end) + "'" + " => " +
+            bindable_type_info<T>::name());
+      }
+      to.push_back(value);
+      first = ptr == last ? last : ptr + 1;
+    }
+  } else {
+    while (first != last) {
+      auto const* end = static_cast<char const*>(std::memchr(
+          first, delimiter, static_cast<std::size_t>(last - first)));
+      if (end == nullptr) {
+        end = last;
+      }
+      T value{};
+      transform_value(
+          std::string_view(first, static_cast<std::size_t>(end - first)),
+          value);
+      to.push_back(std::move(value));
+      first = end == last ? last : end + 1;
+    }
+  }
+}
+
+// container
+template <typename T,
+          std::enable_if_t<is_option_bindable_container_v<T>, bool> = true>
+void insert_or_replace_value(T& bind_value,
+                             std::string_view option_val,
+                             char delimiter = '=') {
+  if (option_val.empty()) {
+    return;
+  }
+  if constexpr (is_map_v<T>) {
+    // both parts are converted before the node is made, and moved into it;
+    // an existing key keeps its value
+    typename T::key_type key{};
+    typename T::mapped_type mapped{};
+    if (auto const index = option_val.find(delimiter);
+        index != std::string_view::npos) {
+      transform_value(option_val.substr(0, index), key);
+      transform_value(option_val.substr(index + 1), mapped);
+    }
+    bind_value.try_emplace(bind_value.end(), std::move(key),
+                           std::move(mapped));
+  } else {
+    typename T::value_type result{};
+    if constexpr (is_pair_v<typename T::value_type> ||
+                  is_fixed_arity_v<typename T::value_type>) {
+      transform_value(option_val, result, delimiter);
+    } else if constexpr (is_vector_v<typename T::value_type>) {
+      transform_list(option_val, result, delimiter);
+    } else {
+      transform_value(option_val, result);
+    }
+    bind_value.push_back(std::move(result));
+  }
+}
+
+// non-container
+template <typename T,
+          std::enable_if_t<!is_option_bindable_container_v<T>, bool> = false>
+void insert_or_replace_value(T& bind_value,
+                             std::string_view option_val,
+                             char delimiter = '=') {
+  if (option_val.empty()) {
+    return;
+  }
+  if constexpr (is_pair_v<T>) {
+    T result;
+    transform_value<T>(option_val, result, delimiter);
+    bind_value = std::move(result);
+  } else if constexpr (is_fixed_arity_v<T>) {
+    transform_value<T>(option_val, bind_value, delimiter);
+  } else {
+    // scalars are only written on success, a std::string keeps its buffer
+    transform_value<T>(option_val, bind_value);
+  }
+}
+
+// Storage for the bindable types which are not alternatives of the value
+// variant: the 64-bit and unsigned integers, float and the pairs, arrays,
+// tuples, vectors and (unordered) maps of them. It holds a scalar in place
+// and anything larger on the heap, or refers to a bound variable, so that
+// it is no larger than the other alternatives of the variant. Only the
+// operations of the stored type are instantiated, so all of these types add
+// one alternative to the variant and no case to the std::visit calls over
+// it.
+class ErasedValue {
+ public:
+  ErasedValue() = default;
+
+  template <typename T>
+  static ErasedValue holding(T value) {
+    ErasedValue erased;
+    erased.ops = &ops_of<T>;
+    erased.owning = true;
+    erased.ptr = ops_of<T>.move(erased.buffer, &value);
+    return erased;
+  }
+
+  template <typename T>
+  static ErasedValue referring(T& target) {
+    ErasedValue erased;
+    erased.ops = &ops_of<T>;
+    erased.ptr = &target;
+    return erased;
+  }
+
+  ErasedValue(ErasedValue const& other)
+      : ops(other.ops), owning(other.owning) {
+    ptr = owning ? ops->copy(buffer, other.ptr) : other.ptr;
+  }
+  ErasedValue(ErasedValue&& other) noexcept { take(std::move(other)); }
+  ErasedValue& operator=(ErasedValue const& other) {
+    if (this != &other) {
+      ErasedValue copy(other);
+      destroy();
+      take(std::move(copy));
+    }
+    return *this;
+  }
+  ErasedValue& operator=(ErasedValue&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      take(std::move(other));
+    }
+    return *this;
+  }
+  ~ErasedValue() { destroy(); }
+
+  // the stored or referred T, nullptr if it is another type
+  template <typename T>
+  T* get_if() const {
+    return ops == &ops_of<T> ? static_cast<T*>(ptr) : nullptr;
+  }
+
+  // Copy assigns the value of other, which has the same type, to the stored
+  // or referred value, so that containers keep their capacity.
+  void assign_value(ErasedValue const& other) { ops->assign(ptr, other.ptr); }
+
+  [[nodiscard]] std::string type_name() const { return ops->name(); }
+  [[nodiscard]] bool is_container() const { return ops->container; }
+
+ private:
+  struct Ops {
+    void* (*copy)(unsigned char* buffer, void const* from);
+    void* (*move)(unsigned char* buffer, void* from);
+    void (*destroy)(void* value);
+    void (*assign)(void* to, void const* from);
+    std::string (*name)();
+    bool container;
+    // stored in the buffer, a heap-held value is moved by its pointer
+    bool in_buffer;
+  };
+
+  // a held T is in the buffer where it fits, on the heap otherwise
+  template <typename T>
+  static constexpr bool fits_buffer =
+      sizeof(T) <= sizeof(std::uint64_t) &&
+      alignof(T) <= alignof(std::uint64_t) &&
+      std::is_nothrow_move_constructible_v<T>;
+
+  template <typename T>
+  static constexpr Ops ops_of{
+      [](unsigned char* buffer, void const* from) -> void* {
+        if constexpr (fits_buffer<T>) {
+          return new (buffer) T(*static_cast<T const*>(from));
+        } else {
+          return new T(*static_cast<T const*>(from));
+        }
+      },
+      [](unsigned char* buffer, void* from) -> void* {
+        if constexpr (fits_buffer<T>) {
+          return new (buffer) T(std::move(*static_cast<T*>(from)));
+        } else {
+          return new T(std::move(*static_cast<T*>(from)));
+        }
+      },
+      [](void* value) {
+        if constexpr (fits_buffer<T>) {
+          static_cast<T*>(value)->~T();
+        } else {
+          delete static_cast<T*>(value);
+        }
+      },
+      [](void* to, void const* from) {
+        if constexpr (is_unordered_map_v<T>) {
+          // copy assignment would also copy the bucket count of from
+          static_cast<T*>(to)->clear();
+          static_cast<T*>(to)->insert(static_cast<T const*>(from)->begin(),
+                                      static_cast<T const*>(from)->end());
+        } else {
+          *static_cast<T*>(to) = *static_cast<T const*>(from);
+        }
+      },
+      &bindable_type_info<T>::name,
+      is_vector_v<T> || is_map_v<T> || is_flat_v<T>,
+      fits_buffer<T>};
+
+  void destroy() {
+    if (owning) {
+      ops->destroy(ptr);
+    }
+    ops = nullptr;
+    ptr = nullptr;
+    owning = false;
+  }
+  // Only a value in the buffer is move constructed; a heap-held one
+  // changes owner without allocating.
+  void take(ErasedValue&& other) noexcept {
+    ops = other.ops;
+    owning = other.owning;
+    if (!owning) {
+      ptr = other.ptr;
+    } else if (ops->in_buffer) {
+      ptr = ops->move(buffer, other.ptr);
+    } else {
+      ptr = std::exchange(other.ptr, nullptr);
+      other.owning = false;
+    }
+  }
+
+  Ops const* ops{nullptr};
+  void* ptr{nullptr};
+  bool owning{false};
+  alignas(std::uint64_t) unsigned char buffer[sizeof(std::uint64_t)];
+};
+
+class OptBase;
+template <typename T>
+class Handle;
+
+// A std::atomic<bool> that copies its value, for members of copyable types.
+class CopyableAtomicBool {
+ public:
+  CopyableAtomicBool() = default;
+  CopyableAtomicBool(CopyableAtomicBool const& other) : value(other.load()) {}
+  CopyableAtomicBool& operator=(CopyableAtomicBool const& other) {
+    store(other.load());
+    return *this;
+  }
+
+  bool load(std::memory_order order = std::memory_order_acquire) const {
+    return value.load(order);
+  }
+  void store(bool desired,
+             std::memory_order order = std::memory_order_release) {
+    value.store(desired, order);
+  }
+
+ private:
+  std::atomic<bool> value{false};
+};
+
+// What one parse changes about an option: its value (held, or bound to a
+// variable of the caller), how often it was hit and whether it still holds
+// its default. ArgParser::parse() updates the states owned by the options,
+// ParserSpec::parse() updates the states of a fresh ParseResult.
+class OptState {
+  friend class OptBase;
+  friend class Flag;
+  friend class Option;
+  friend class Positional;
+  friend class ArgParser;
+  friend class ParseResult;
+  template <typename T>
+  friend class Handle;
+
+ public:
+  template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
+  T const& get() const {
+    validate();
+    if (auto const* target = target_if<T>()) {
+      return *target;
+    }
+    throw bad_value_access("bad value access as: " + value_type_name() +
+                           " => " + bindable_type_info<T>::name());
+  }
+
+  [[nodiscard]] int count() const { return hit_count; }
+
+  // Converts the values a lazy option recorded during parse, throwing the
+  // first conversion error. The first get<T>() does so at the latest.
+  // Concurrent calls on one state convert once: the first takes a lock, the
+  // others wait for it, and every call after that only loads a flag.
+  void validate() const {
+    if (has_pending.load()) {
+      convert_pending_once();
+    }
+  }
+
+ private:
+  void convert_pending_once() const {
+    static std::mutex conversion;
+    std::lock_guard<std::mutex> lock(conversion);
+    if (!pending.empty()) {
+      // the conversion is a cache fill, the observable value is the same
+      const_cast<OptState*>(this)->convert_pending();
+    }
+  }
+
+  using value_type = variant_push_back<
+      make_variant_type<bool, int, double, std::string>::type,
+      ErasedValue>::type;
+
+  explicit OptState(value_type val) : value(std::move(val)) {}
+
+  // a value holding a T, or referring to the variable target
+  template <typename T>
+  static value_type make_value(T val) {
+    if constexpr (is_variant_alternative_v<T, value_type>) {
+      return value_type(std::in_place_type<T>, std::move(val));
+    } else {
+      return ErasedValue::holding(std::move(val));
+    }
+  }
+  template <typename T>
+  static value_type make_reference(T& target) {
+    if constexpr (is_variant_alternative_v<T, value_type>) {
+      return value_type(std::in_place_type<std::reference_wrapper<T>>, target);
+    } else {
+      return ErasedValue::referring(target);
+    }
+  }
+
+  // defined after OptBase
+  void convert_pending();
+
+  // the T held, referenced or erased by value, nullptr for another type
+  template <typename T>
+  T* target_if() {
+    if constexpr (is_variant_alternative_v<T, value_type>) {
+      if (auto* ref = std::get_if<std::reference_wrapper<T>>(&value)) {
+        return &ref->get();
+      }
+      return std::get_if<T>(&value);
+    } else {
+      if (auto* erased = std::get_if<ErasedValue>(&value)) {
+        return erased->get_if<T>();
+      }
+      return nullptr;
+    }
+  }
+  template <typename T>
+  T const* target_if() const {
+    return const_cast<OptState*>(this)->target_if<T>();
+  }
+
+  // the T of a handler instantiated for the bound type
+  template <typename T>
+  T& value_as() {
+    return *target_if<T>();
+  }
+
+  std::string value_type_name() const {
+    return std::visit(
+        overloaded{[](auto& v) {
+          using type =
+              std::remove_const_t<std::remove_reference_t<decltype(v)>>;
+          if constexpr (std::is_same_v<ErasedValue, type>) {
+            return v.type_name();
+          } else if constexpr (is_reference_wrapper_v<type>) {
+            return bindable_type_info<typename type::type>::name();
+          } else {
+            return bindable_type_info<type>::name();
+          }
+        }},
+        value);
+  }
+
+  value_type value;
+  int hit_count{0};
+  bool current_is_default_value{false};
+  // cleared once a single value positional took its argument
+  bool can_set_value{true};
+  // raw values recorded by a lazy option, pointing into argv
+  std::vector<std::string_view> pending{};
+  // !pending.empty(), read by validate() without the lock
+  CopyableAtomicBool has_pending{};
+  OptBase const* lazy_owner{nullptr};
+};
+
+class OptBase {
+  friend class ArgParser;
+  friend class ParseResult;
+  friend class ParserSpec;
+  friend class OptState;
+  template <typename T>
+  friend class Handle;
+
+ protected:
   enum class Type { FLAG, ALIAS_FLAG, OPTION, POSITIONAL };
 
  public:
   virtual ~OptBase() = default;
-  OptBase::Type virtual type() const = 0;
+  OptBase::Type type() const { return opt_type; }
   bool is_flag() const {
     return Type::FLAG == this->type() || is_alias_flag();
   };
@@ -477,44 +1770,12 @@ class OptBase {
 
   template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
   T const& get() const {
-    try {
-      if (std::holds_alternative<std::reference_wrapper<T>>(value)) {
-        return std::get<std::reference_wrapper<T>>(value).get();
-      }
-      return std::get<T>(value);
-    } catch (std::bad_variant_access const& e) {
-      throw bad_value_access(std::string(e.what()) +
-                             " as: " + value_type_name() + " => " +
-                             bindable_type_info<T>::name());
-    }
+    return state.get<T>();
   }
 
+  // defined after Positional, it also re-resolves the hit handler
   template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
-  OptBase& bind(T& bind_val) {
-    if (is_flag()) {
-      if constexpr (is_flag_bindable_value_v<T>) {
-        value = std::ref(bind_val);
-      } else {
-        throw bad_value_access(std::string("flag can't bind the type: ") +
-                               bindable_type_info<T>::name());
-      }
-    } else if (is_option()) {
-      if constexpr (is_option_bindable_value_v<T>) {
-        value = std::ref(bind_val);
-      } else {
-        throw bad_value_access(std::string("option can't bind the type: ") +
-                               bindable_type_info<T>::name());
-      }
-    } else if (is_positional()) {
-      if constexpr (is_position_bindable_value_v<T>) {
-        value = std::ref(bind_val);
-      } else {
-        throw bad_value_access(std::string("positional can't bind the type: ") +
-                               bindable_type_info<T>::name());
-      }
-    }
-    return *this;
-  }
+  OptBase& bind(T& bind_val);
 
   OptBase& help(std::string const& help) {
     help_msg = help;
@@ -525,14 +1786,30 @@ class OptBase {
     return *this;
   }
 
+  // Defers converting the values of this option or positional to its first
+  // get<T>() or to validate(): parse() only records views of the raw
+  // arguments, which must stay alive until then. A bound variable is only
+  // written by that conversion, it keeps its value from before parse()
+  // until get<T>() or validate() runs. The conversion runs once even when
+  // several threads call get<T>() on the same result. Flags have nothing to
+  // convert.
+  OptBase& lazy() {
+    lazy_conversion = true;
+    on_hit = record;
+    return *this;
+  }
+
   // for const char*
   OptBase& set_default(std::string const& def_val) {
     return set_default<std::string>(def_val);
   }
   template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
   OptBase& set_default(T const& def_val) {
-    current_is_default_value = true;
-    return set_init_value(def_val);
+    set_init_value(def_val);
+    state.current_is_default_value = true;
+    has_default = true;
+    default_value = OptState::make_value<T>(def_val);
+    return *this;
   }
 
   // template <typename T>
@@ -554,141 +1831,221 @@ class OptBase {
   //   return *this;
   // }
 
-  [[nodiscard]] int count() const { return hit_count; }
+  [[nodiscard]] int count() const { return state.count(); }
   OptBase(OptBase const&) = delete;
   OptBase(OptBase&&) = delete;
   OptBase& operator=(OptBase const&) = delete;
   OptBase& operator=(OptBase&&) = delete;
 
  protected:
-  using value_type = make_variant_type<bool, int, double, std::string>::type;
+  using value_type = OptState::value_type;
   template <typename T>
   struct identity {
     using type = T;
   };
+  // Parse-time entry point of an option. It is instantiated for the bound
+  // type and (re)assigned whenever value is bound, so the parse loop needs
+  // neither RTTI, virtual calls nor a std::visit over value.
+  using hit_handler = void (*)(OptBase const& opt,
+                               OptState& state,
+                               std::string_view val,
+                               bool negated);
+  // Runs once after the values of a parse are stored, nullptr if the bound
+  // type needs nothing then.
+  using finish_handler = void (*)(OptState& state);
+
+  template <typename T>
+  static void finish_as(OptState& state) {
+    state.value_as<T>().sort_unique();
+  }
+  template <typename T>
+  static constexpr finish_handler finish_of() {
+    if constexpr (is_flat_v<T>) {
+      return &OptBase::finish_as<T>;
+    } else {
+      return nullptr;
+    }
+  }
 
   template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
-  OptBase(identity<T> /*unused*/, T& bind) : value(std::ref(bind)) {}
+  OptBase(Type type, identity<T> /*unused*/, T& bind)
+      : opt_type(type),
+        finish(finish_of<T>()),
+        type_placeholder(default_value_help<T>()),
+        state(OptState::make_reference(bind)),
+        default_value(OptState::make_value<T>(bind)) {}
 
   template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
-  explicit OptBase(identity<T> /*unused*/) : value(T{}) {}
+  OptBase(Type type, identity<T> /*unused*/)
+      : opt_type(type),
+        finish(finish_of<T>()),
+        type_placeholder(default_value_help<T>()),
+        state(OptState::make_value(T{})),
+        default_value(OptState::make_value(T{})) {}
 
-  virtual void hit(char short_name) = 0;
-  virtual void hit(std::string const& long_name) = 0;
-  virtual void hit(char short_name, std::string const& val) = 0;
-  virtual void hit(std::string const& long_name, std::string const& val) = 0;
   [[nodiscard]] virtual std::string usage() const = 0;
   [[nodiscard]] virtual std::string short_usage() const = 0;
 
-  [[nodiscard]] virtual bool contains(std::string const& name) const {
-    return end(flag_and_option_names) !=
-           find(begin(flag_and_option_names), end(flag_and_option_names), name);
+  // convert stores a value into the bound type, record keeps it for a lazy
+  // conversion; both are re-resolved whenever the bound type changes
+  void set_handlers(hit_handler convert_handler, hit_handler record_handler) {
+    convert = convert_handler;
+    record = record_handler;
+    on_hit = lazy_conversion ? record : convert;
   }
-  void add_option_name(std::string opt_name) {
-    flag_and_option_names.push_back(std::move(opt_name));
+
+  static void record_value(OptBase const& opt,
+                           OptState& state,
+                           std::string_view val,
+                           bool /*negated*/) {
+    state.pending.push_back(val);
+    state.has_pending.store(true, std::memory_order_relaxed);
+    state.lazy_owner = &opt;
   }
-  std::vector<std::string> const& option_names() const {
-    return flag_and_option_names;
+
+  // Puts the default value back, copy assigning it so that containers and
+  // strings keep their capacity for the next parse.
+  void reset() {
+    reset_value();
+    state.hit_count = 0;
+    state.current_is_default_value = has_default;
+    state.can_set_value = true;
+    state.pending.clear();
+    state.has_pending.store(false, std::memory_order_relaxed);
   }
 
-  template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
-  OptBase& set_init_value(T const& init_val) {
+  void reset_value() {
     std::visit(
-        [this, &init_val](auto& val) {
+        [this](auto& val) {
           using type = std::remove_reference_t<decltype(val)>;
-          if constexpr (is_reference_wrapper_v<type>) {
-            if constexpr (std::is_same_v<typename type::type, T>) {
-              val.get() = init_val;
-            } else {
-              throw bad_value_access(std::string("err: ") + value_type_name() +
-                                     " <= " + bindable_type_info<T>::name());
-            }
+          if constexpr (std::is_same_v<ErasedValue, type>) {
+            val.assign_value(*std::get_if<ErasedValue>(&default_value));
+          } else if constexpr (is_reference_wrapper_v<type>) {
+            val.get() = *std::get_if<typename type::type>(&default_value);
           } else {
-            if constexpr (std::is_same_v<type, T>) {
-              val = init_val;
-            } else {
-              throw bad_value_access(std::string("err: ") + value_type_name() +
-                                     " <= " + bindable_type_info<T>::name());
-            }
+            val = *std::get_if<type>(&default_value);
           }
         },
-        value);
-    return *this;
+        state.value);
   }
 
-  std::string value_type_name() const {
-    return std::visit(
-        overloaded{[](auto& v) {
-          using type =
-              std::remove_const_t<std::remove_reference_t<decltype(v)>>;
-          if constexpr (is_reference_wrapper_v<type>) {
-            return bindable_type_info<typename type::type>::name();
-          } else {
-            return bindable_type_info<type>::name();
-          }
-        }},
-        value);
+  // the state a parse into a fresh ParseResult starts from
+  [[nodiscard]] OptState initial_state() const {
+    OptState initial(default_value);
+    initial.current_is_default_value = has_default;
+    return initial;
+  }
+
+  void add_option_name(std::string opt_name) {
+    flag_and_option_names.push_back(std::move(opt_name));
+  }
+  std::vector<std::string> const& option_names() const {
+    return flag_and_option_names;
+  }
+
+  template <typename T, typename = std::enable_if_t<is_bindable_value_v<T>>>
+  OptBase& set_init_value(T const& init_val) {
+    auto* target = state.target_if<T>();
+    if (target == nullptr) {
+      throw bad_value_access(std::string("err: ") + state.value_type_name() +
+                             " <= " + bindable_type_info<T>::name());
+    }
+    *target = init_val;
+    return *this;
   }
 
   std::string const& get_value_help() const { return value_placeholder; }
   std::string const& get_help() const { return help_msg; }
-  void increment_count() { hit_count++; }
+  Type opt_type;
+  hit_handler on_hit{nullptr};
+  hit_handler convert{nullptr};
+  hit_handler record{nullptr};
+  finish_handler finish{nullptr};
+  // Counts the finish handlers bind() changed, in any parser: a compiled
+  // parser caches its options with a finish handler, see
+  // ArgParser::compile().
+  static inline std::atomic<std::size_t> finish_generation{0};
+  bool lazy_conversion{false};
   std::vector<std::string> flag_and_option_names;
   std::string help_msg;
   std::string value_placeholder;
-  value_type value;
-  bool current_is_default_value{false};
-  int hit_count{0};
+  // shown instead of an empty value_placeholder, see default_value_help()
+  std::string_view type_placeholder{"TEXT"};
+  OptState state;
+  // the unbound value and default flag that every parse starts from
+  value_type default_value;
+  bool has_default{false};
+  // position in ArgParser::all_options, assigned by ArgParser::compile()
+  std::size_t index{0};
 };
+
+inline void OptState::convert_pending() {
+  std::size_t done = 0;
+  try {
+    for (; done < pending.size(); done++) {
+      lazy_owner->convert(*lazy_owner, *this, pending[done], false);
+    }
+    if (lazy_owner->finish != nullptr) {
+      lazy_owner->finish(*this);
+    }
+  } catch (...) {
+    // keep the failing value first so every later get() reports it again
+    pending.erase(pending.begin(),
+                  pending.begin() + static_cast<std::ptrdiff_t>(done));
+    throw;
+  }
+  pending.clear();
+  has_pending.store(false);
+}
 class ArgParser;
 class Flag : public OptBase {
   friend class ArgParser;
-
- public:
-  OptBase::Type type() const override { return OptBase::Type::FLAG; };
+  friend class OptBase;
 
  protected:
   template <typename T,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  std::unique_ptr<Flag> static make_flag(std::string const& flag_desc,
+  std::unique_ptr<Flag> static make_flag(std::string_view flag_desc,
                                          T& bind) {
     return std::unique_ptr<Flag>(new Flag(flag_desc, bind));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  std::unique_ptr<Flag> static make_flag(std::string const& flag_desc) {
+  std::unique_ptr<Flag> static make_flag(std::string_view flag_desc) {
     return std::unique_ptr<Flag>(new Flag(flag_desc, OptBase::identity<T>{}));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  Flag(std::string const& flag_desc, T& bind)
-      : OptBase(typename OptBase::identity<T>{}, bind) {
+  Flag(std::string_view flag_desc, T& bind)
+      : OptBase(Type::FLAG, typename OptBase::identity<T>{}, bind) {
+    set_handlers(&Flag::hit_as<T>, &Flag::hit_as<T>);
     Flag_init(flag_desc);
   }
   template <typename T,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  Flag(std::string const& flag_desc, OptBase::identity<T> /*unused*/)
-      : OptBase(typename OptBase::identity<T>{}) {
+  Flag(std::string_view flag_desc, OptBase::identity<T> /*unused*/)
+      : OptBase(Type::FLAG, typename OptBase::identity<T>{}) {
+    set_handlers(&Flag::hit_as<T>, &Flag::hit_as<T>);
     Flag_init(flag_desc);
   }
-  [[nodiscard]] bool negate_contains(std::string const& flag) const {
-    return find(begin(negate_flag_names), end(negate_flag_names), flag) !=
-           end(negate_flag_names);
-  }
-
-  [[nodiscard]] bool contains(std::string const& flag) const override {
-    return OptBase::contains(flag) || negate_contains(flag);
-  }
 
-  void hit(char const flag) override { hit(std::string(1, flag)); }
-  void hit(std::string const& flag) override { hit_impl(flag); }
-  void hit(char const flag, std::string const& val) override {
-    hit(std::string(1, flag), val);
-  }
-  void hit(std::string const& /*flag*/, std::string const& /*val*/) override {
-    UNREACHABLE();
+  template <typename T>
+  static void hit_as(OptBase const& /*opt*/,
+                     OptState& state,
+                     std::string_view /*val*/,
+                     bool negated) {
+    auto& val = state.value_as<T>();
+    if constexpr (std::is_same_v<bool, T>) {
+      val = !negated;
+    } else {
+      if (state.current_is_default_value) {
+        val = 0;
+      }
+      val += negated ? -1 : 1;
+    }
+    state.current_is_default_value = false;
   }
 
   [[nodiscard]] std::string usage() const override {
@@ -720,34 +2077,21 @@ class Flag : public OptBase {
   }
 
  private:
-  void Flag_init(std::string const& flag_desc) {
-    // TODO(shediao): trim left and right blank
+  void Flag_init(std::string_view flag_desc) {
     // flag is ,
-    auto all = StringUtil::split(flag_desc, ',');
-    if (all.empty()) {
-      throw std::logic_error("flag name is empty");
-    }
-    for (auto f : all) {
-      bool is_negate{false};
+    bool any{false};
+    StringUtil::for_each_part(flag_desc, ',', [this, &any](std::string_view f) {
+      any = true;
       if (f.empty()) {
         throw std::logic_error("flag item name is empty");
       }
-      f = std::string(
-          find_if_not(begin(f), end(f), [](char c) { return std::isspace(c); }),
-          find_if_not(rbegin(f), rend(f), [](char c) {
-            return std::isspace(c);
-          }).base());
-
-      if (f[0] == '!') {
-        is_negate = true;
-        f = f.substr(1);
-      }
+      f = StringUtil::trim(f);
 
-      if (StringUtil::startswith(f, "--")) {
-        f = f.substr(2);
-      } else if (StringUtil::startswith(f, "-")) {
-        f = f.substr(1);
+      bool const is_negate = StringUtil::startswith(f, "!");
+      if (is_negate) {
+        f.remove_prefix(1);
       }
+      f = StringUtil::strip_dashes(f);
 
       if (f.empty()) {
         throw std::logic_error("flag item name is empty");
@@ -756,133 +2100,74 @@ class Flag : public OptBase {
         throw std::logic_error("flag item name is startswith '-'");
       }
       if (is_negate) {
-        negate_flag_names.push_back(f);
+        negate_flag_names.emplace_back(f);
       } else {
-        add_option_name(std::move(f));
+        add_option_name(std::string(f));
       }
+    });
+    if (!any) {
+      throw std::logic_error("flag name is empty");
     }
   }
-  template <typename ShortOrLong>
-  void hit_impl(ShortOrLong const& flag) {
-    increment_count();
-    std::visit(
-        overloaded{
-            [this, &flag](bool& val) {
-              if (negate_contains(flag)) {
-                val = false;
-              } else if (OptBase::contains(flag)) {
-                val = true;
-              } else {
-                UNREACHABLE();
-              }
-            },
-            [this, &flag](std::reference_wrapper<bool>& val) {
-              if (negate_contains(flag)) {
-                val.get() = false;
-              } else if (OptBase::contains(flag)) {
-                val.get() = true;
-              } else {
-                UNREACHABLE();
-              }
-            },
-            [this, &flag](auto& val) {
-              using type = std::remove_reference_t<decltype(val)>;
-              if constexpr (is_reference_wrapper_v<type>) {
-                if constexpr (is_flag_bindable_value_v<typename type::type>) {
-                  if (current_is_default_value) {
-                    val.get() = 0;
-                  }
-                  if (negate_contains(flag)) {
-                    val.get() -= 1;
-                  } else if (OptBase::contains(flag)) {
-                    val.get() += 1;
-                  } else {
-                    UNREACHABLE();
-                  }
-                } else {
-                  UNREACHABLE();
-                }
-              } else {
-                if constexpr (is_flag_bindable_value_v<type>) {
-                  if (current_is_default_value) {
-                    val = 0;
-                  }
-                  if (negate_contains(flag)) {
-                    val -= 1;
-                  } else if (OptBase::contains(flag)) {
-                    val += 1;
-                  } else {
-                    UNREACHABLE();
-                  }
-                } else {
-                  UNREACHABLE();
-                }
-              }
-            }},
-        value);
-    current_is_default_value = false;
-  }
-
   std::vector<std::string> negate_flag_names{};
 };
 
 class AliasFlag : public Flag {
   friend class ArgParser;
 
- public:
-  OptBase::Type type() const override { return OptBase::Type::ALIAS_FLAG; };
-
  protected:
   std::unique_ptr<AliasFlag> static make_flag(
-      std::string const& flag_desc,
+      std::string_view flag_desc,
       std::pair<std::string, std::string> option) {
     return std::unique_ptr<AliasFlag>(
         new AliasFlag(flag_desc, std::move(option)));
   }
-  explicit AliasFlag(std::string const& flag_desc,
+  explicit AliasFlag(std::string_view flag_desc,
                      std::pair<std::string, std::string> option)
       : Flag(flag_desc, OptBase::identity<bool>{}),
         option_name(std::move(std::move(option).first)),
-        option_value(std::move(std::move(option).second)) {}
-  void hit(char const flag) override { Flag::hit(flag); }
-  void hit(std::string const& flag) override { Flag::hit(flag); }
+        option_value(std::move(std::move(option).second)) {
+    opt_type = Type::ALIAS_FLAG;
+  }
 
  private:
   std::string option_name;
   std::string option_value;
+  // resolved by ArgParser::compile()
+  OptBase* option{nullptr};
 };
 
 class Option : public OptBase {
   friend class ArgParser;
-
- public:
-  OptBase::Type type() const override { return OptBase::Type::OPTION; };
+  friend class OptBase;
 
  protected:
   template <typename T,
             typename = std::enable_if_t<is_option_bindable_value_v<T>>>
-  std::unique_ptr<Option> static make_option(std::string const& option_desc,
+  std::unique_ptr<Option> static make_option(std::string_view option_desc,
                                              T& bind) {
     return std::unique_ptr<Option>(new Option(option_desc, bind));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_option_bindable_value_v<T>>>
-  std::unique_ptr<Option> static make_option(std::string const& option_desc) {
+  std::unique_ptr<Option> static make_option(std::string_view option_desc) {
     return std::unique_ptr<Option>(
         new Option(option_desc, OptBase::identity<T>{}));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_option_bindable_value_v<T>>>
-  Option(std::string const& option_desc, T& bind)
-      : OptBase(typename OptBase::identity<T>{}, bind) {
+  Option(std::string_view option_desc, T& bind)
+      : OptBase(Type::OPTION, typename OptBase::identity<T>{}, bind) {
+    set_handlers(&Option::hit_as<T>, &OptBase::record_value);
     Option_init(option_desc);
   }
   template <typename T,
             typename = std::enable_if_t<is_option_bindable_value_v<T>>>
-  Option(std::string const& option_desc, OptBase::identity<T> /*unused*/)
-      : OptBase(typename OptBase::identity<T>{}) {
+  Option(std::string_view option_desc, OptBase::identity<T> /*unused*/)
+      : OptBase(Type::OPTION, typename OptBase::identity<T>{}) {
+    set_handlers(&Option::hit_as<T>, &OptBase::record_value);
     Option_init(option_desc);
   }
   [[nodiscard]] std::string usage() const override {
@@ -895,7 +2180,7 @@ class Option : public OptBase {
         ss << "," << (it->length() == 1 ? "-" : "--") << *it;
       }
       if (get_value_help().empty()) {
-        ss << "=<TEXT>";
+        ss << "=<" << type_placeholder << ">";
       } else {
         ss << "=<" << get_value_help() << ">";
       }
@@ -917,7 +2202,7 @@ class Option : public OptBase {
       }
       ss << " ";
       if (get_value_help().empty()) {
-        ss << "<TEXT>";
+        ss << "<" << type_placeholder << ">";
       } else {
         ss << "<" << get_value_help() << ">";
       }
@@ -926,62 +2211,48 @@ class Option : public OptBase {
     return ss.str();
   }
 
-  void hit(std::string const& /*long_name*/, std::string const& val) override {
-    return hit_impl(val);
-  }
-  void hit(char /*short_name*/, std::string const& val) override {
-    return hit_impl(val);
-  }
-  void hit(std::string const& /*flag*/) override { UNREACHABLE(); }
-  void hit(char const /*flag*/) override { UNREACHABLE(); }
-
- private:
-  void Option_init(std::string const& option_desc) {
-    auto all = StringUtil::split(option_desc, ',');
-    if (all.empty()) {
-      throw std::logic_error("option name is empty");
-    }
-    for (auto f : all) {
-      f = std::string(
-          find_if_not(begin(f), end(f), [](char c) { return std::isspace(c); }),
-          find_if_not(rbegin(f), rend(f), [](char c) {
-            return std::isspace(c);
-          }).base());
-      if (StringUtil::startswith(f, "--")) {
-        f = f.substr(2);
-      } else if (StringUtil::startswith(f, "-")) {
-        f = f.substr(1);
+  template <typename T>
+  static void hit_as(OptBase const& opt,
+                     OptState& state,
+                     std::string_view val,
+                     bool /*negated*/) {
+    auto& bind = state.value_as<T>();
+    if constexpr (is_option_bindable_container_v<T>) {
+      if (state.current_is_default_value) {
+        bind.clear();
       }
-      if (f.empty()) {
-        throw std::logic_error("option item name is empty");
+    }
+    if constexpr (is_unordered_map_v<T>) {
+      // A lazy option converts after every occurrence is counted and sizes
+      // the table once. Eager hits leave growth to the container: reserving
+      // for the running count would rehash at every next prime.
+      auto const count = static_cast<std::size_t>(state.hit_count);
+      if (!state.pending.empty() &&
+          static_cast<float>(count) >
+          static_cast<float>(bind.bucket_count()) * bind.max_load_factor()) {
+        bind.reserve(count);
       }
-      add_option_name(std::move(f));
     }
+    insert_or_replace_value(bind, val,
+                            static_cast<Option const&>(opt).delimiter);
+    state.current_is_default_value = false;
   }
 
-  void hit_impl(std::string const& opt_val) {
-    increment_count();
-    std::visit(
-        [&opt_val, this](auto& x) {
-          using T = std::remove_reference_t<decltype(x)>;
-          if constexpr (is_reference_wrapper_v<T>) {
-            if constexpr (is_option_bindable_container_v<typename T::type>) {
-              if (current_is_default_value) {
-                x.get().clear();
-              }
-            }
-            insert_or_replace_value(x.get(), opt_val, delimiter);
-          } else {
-            if constexpr (is_option_bindable_container_v<T>) {
-              if (current_is_default_value) {
-                x.clear();
-              }
-            }
-            insert_or_replace_value(x, opt_val, delimiter);
+ private:
+  void Option_init(std::string_view option_desc) {
+    bool any{false};
+    StringUtil::for_each_part(
+        option_desc, ',', [this, &any](std::string_view f) {
+          any = true;
+          f = StringUtil::strip_dashes(StringUtil::trim(f));
+          if (f.empty()) {
+            throw std::logic_error("option item name is empty");
           }
-        },
-        value);
-    current_is_default_value = false;
+          add_option_name(std::string(f));
+        });
+    if (!any) {
+      throw std::logic_error("option name is empty");
+    }
   }
 
   char delimiter{'\0'};
@@ -989,57 +2260,48 @@ class Option : public OptBase {
 
 class Positional : public OptBase {
   friend class ArgParser;
-
- public:
-  OptBase::Type type() const override { return OptBase::Type::POSITIONAL; };
+  friend class OptBase;
 
  protected:
   template <typename T>
-  static std::unique_ptr<Positional> make_positional(std::string const& name,
+  static std::unique_ptr<Positional> make_positional(std::string_view name,
                                                      T& bind) {
     return std::unique_ptr<Positional>(new Positional(name, bind));
   }
   template <typename T>
-  static std::unique_ptr<Positional> make_positional(std::string const& name) {
+  static std::unique_ptr<Positional> make_positional(std::string_view name) {
     return std::unique_ptr<Positional>(
         new Positional(name, OptBase::identity<T>{}));
   }
 
-  void hit(char /*short_name*/) override { UNREACHABLE(); };
-  void hit(std::string const& /*long_name*/) override { UNREACHABLE(); };
-  void hit(char /*short_name*/, std::string const& val) override {
-    UNREACHABLE();
-  };
-  void hit(std::string const& long_name, std::string const& val) override {
-    std::visit(
-        overloaded{[&val, this](auto& v) {
-          using type = std::remove_reference_t<decltype(v)>;
-          if constexpr (is_reference_wrapper_v<type>) {
-            if constexpr (is_option_bindable_container_v<typename type::type>) {
-              if (current_is_default_value) {
-                v.get().clear();
-              }
-            }
-            insert_or_replace_value(v.get(), val, delimiter);
-            if constexpr (!is_option_bindable_container_v<
-                              typename type::type>) {
-              can_set_value = false;
-            }
-          } else {
-            if constexpr (is_option_bindable_container_v<type>) {
-              if (current_is_default_value) {
-                v.clear();
-              }
-            }
-            insert_or_replace_value(v, val, delimiter);
-            if constexpr (!is_option_bindable_container_v<type>) {
-              can_set_value = false;
-            }
-          }
-        }},
-        value);
-    current_is_default_value = false;
-  };
+  template <typename T>
+  static void hit_as(OptBase const& opt,
+                     OptState& state,
+                     std::string_view val,
+                     bool /*negated*/) {
+    auto& bind = state.value_as<T>();
+    if constexpr (is_option_bindable_container_v<T>) {
+      if (state.current_is_default_value) {
+        bind.clear();
+      }
+    }
+    insert_or_replace_value(bind, val,
+                            static_cast<Positional const&>(opt).delimiter);
+    if constexpr (!is_option_bindable_container_v<T>) {
+      state.can_set_value = false;
+    }
+    state.current_is_default_value = false;
+  }
+  template <typename T>
+  static void record_as(OptBase const& opt,
+                        OptState& state,
+                        std::string_view val,
+                        bool negated) {
+    OptBase::record_value(opt, state, val, negated);
+    if constexpr (!is_option_bindable_container_v<T>) {
+      state.can_set_value = false;
+    }
+  }
 
   [[nodiscard]] std::string usage() const override {
     std::ostringstream ss;
@@ -1059,14 +2321,16 @@ class Positional : public OptBase {
         [](auto& v) {
           using type =
               std::remove_const_t<std::remove_reference_t<decltype(v)>>;
-          if constexpr (is_reference_wrapper_v<type>) {
+          if constexpr (std::is_same_v<ErasedValue, type>) {
+            return v.is_container();
+          } else if constexpr (is_reference_wrapper_v<type>) {
             return (is_vector_v<typename type::type> ||
                     is_map_v<typename type::type>);
           } else {
             return (is_vector_v<type> || is_map_v<type>);
           }
         },
-        value);
+        state.value);
     if (!option_names().empty()) {
       if (is_multi_positional) {
         if (get_value_help().empty()) {
@@ -1082,25 +2346,251 @@ class Positional : public OptBase {
         }
       }
     }
-    return ss.str();
+    return ss.str();
+  }
+
+  template <typename T>
+  Positional(std::string_view name, T& bind)
+      : OptBase(Type::POSITIONAL, OptBase::identity<T>{}, bind) {
+    set_handlers(&Positional::hit_as<T>, &Positional::record_as<T>);
+    add_option_name(std::string(name));
+  }
+
+  template <typename T>
+  Positional(std::string_view name, OptBase::identity<T>)
+      : OptBase(Type::POSITIONAL, OptBase::identity<T>{}) {
+    set_handlers(&Positional::hit_as<T>, &Positional::record_as<T>);
+    add_option_name(std::string(name));
+  }
+  char delimiter{'\0'};
+};
+
+template <typename T, typename>
+OptBase& OptBase::bind(T& bind_val) {
+  if (is_flag()) {
+    if constexpr (is_flag_bindable_value_v<T>) {
+      state.value = OptState::make_reference(bind_val);
+      set_handlers(&Flag::hit_as<T>, &Flag::hit_as<T>);
+    } else {
+      throw bad_value_access(std::string("flag can't bind the type: ") +
+                             bindable_type_info<T>::name());
+    }
+  } else if (is_option()) {
+    if constexpr (is_option_bindable_value_v<T>) {
+      state.value = OptState::make_reference(bind_val);
+      set_handlers(&Option::hit_as<T>, &OptBase::record_value);
+    } else {
+      throw bad_value_access(std::string("option can't bind the type: ") +
+                             bindable_type_info<T>::name());
+    }
+  } else if (is_positional()) {
+    if constexpr (is_position_bindable_value_v<T>) {
+      state.value = OptState::make_reference(bind_val);
+      set_handlers(&Positional::hit_as<T>, &Positional::record_as<T>);
+    } else {
+      throw bad_value_access(std::string("positional can't bind the type: ") +
+                             bindable_type_info<T>::name());
+    }
+  }
+  default_value = OptState::make_value<T>(bind_val);
+  type_placeholder = default_value_help<T>();
+  if (auto const handler = finish_of<T>(); handler != finish) {
+    finish = handler;
+    finish_generation.fetch_add(1, std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+struct FieldEntry;
+
+// How ArgParser::bind_struct() parses, finishes, resets and describes a
+// member of type T, and ArgParser::add_flag() a bit of a Word. There is one
+// table per type, shared by every member or bit of that type.
+struct FieldOps {
+  void (*hit)(FieldEntry const& field, std::string_view val, bool negated);
+  // nullptr if the type needs nothing after a parse, see field_finish_of()
+  void (*finish)(void* member);
+  // puts back the value field.initial points to
+  void (*reset)(FieldEntry const& field);
+  std::string_view (*type_placeholder)();
+  bool flag;
+};
+
+// A member bound by ArgParser::bind_struct() or a bit bound by
+// ArgParser::add_flag(): the name index and the short table resolve to it
+// directly, and a hit converts into the member, or sets the bit, without an
+// option object or a value variant. The names are views into the
+// descriptor of the caller's field table, or into the parser's copy of a
+// flag descriptor.
+struct FieldEntry {
+  FieldOps const* ops{nullptr};
+  // base + offset of the member in the bound object, or the word of a bit
+  void* member{nullptr};
+  // the same member of the copy bind_struct() made, or the bool a bit had
+  // when bound, restored by reset()
+  void const* initial{nullptr};
+  std::string_view descriptor{};
+  std::string_view help{};
+  // set by the hits of ArgParser::parse(), cleared by reset()
+  mutable bool hit{false};
+  // the index of a bit in its word
+  std::size_t bit{0};
+};
+
+template <typename T>
+constexpr auto field_finish_of() -> void (*)(void* member) {
+  if constexpr (is_flat_v<T>) {
+    return [](void* member) { static_cast<T*>(member)->sort_unique(); };
+  } else {
+    return nullptr;
+  }
+}
+
+template <typename T>
+inline constexpr FieldOps field_ops_of{
+    [](FieldEntry const& field, std::string_view val, bool negated) {
+      if constexpr (std::is_same_v<bool, T>) {
+        *static_cast<T*>(field.member) = !negated;
+      } else {
+        insert_or_replace_value(*static_cast<T*>(field.member), val,
+                                default_delimiter_v<T>);
+      }
+    },
+    field_finish_of<T>(),
+    [](FieldEntry const& field) {
+      auto& member = *static_cast<T*>(field.member);
+      auto const& from = *static_cast<T const*>(field.initial);
+      if constexpr (is_unordered_map_v<T>) {
+        // copy assignment would also copy the bucket count of from
+        member.clear();
+        member.insert(from.begin(), from.end());
+      } else {
+        member = from;
+      }
+    },
+    &default_value_help<T>,
+    std::is_same_v<bool, T>};
+
+// what FieldEntry::initial points to for a bit
+inline constexpr bool flag_bit_values[2]{false, true};
+
+template <typename Word>
+bool test_flag_bit(Word const& word, std::size_t bit) {
+  if constexpr (std::is_unsigned_v<Word>) {
+    return ((word >> bit) & 1U) != 0;
+  } else {
+    return word.test(bit);
+  }
+}
+
+template <typename Word>
+void set_flag_bit(Word& word, std::size_t bit, bool value) {
+  if constexpr (std::is_unsigned_v<Word>) {
+    auto const mask = static_cast<Word>(Word{1} << bit);
+    word = static_cast<Word>(value ? word | mask : word & ~mask);
+  } else {
+    word.set(bit, value);
+  }
+}
+
+template <typename Word>
+inline constexpr FieldOps flag_bit_ops_of{
+    [](FieldEntry const& field, std::string_view /*val*/, bool negated) {
+      set_flag_bit(*static_cast<Word*>(field.member), field.bit, !negated);
+    },
+    nullptr,
+    [](FieldEntry const& field) {
+      set_flag_bit(*static_cast<Word*>(field.member), field.bit,
+                   *static_cast<bool const*>(field.initial));
+    },
+    &default_value_help<bool>,
+    true};
+
+// Open-addressing hash index from every flag, option and positional name
+// (negated flag names included) to the option owning it. It is rebuilt by
+// ArgParser::compile() and resolves a name with a single probe sequence.
+class NameIndex {
+ public:
+  // the name of an option, of a bind_struct() field or of a flag bit
+  struct Entry {
+    [[nodiscard]] bool is_flag() const {
+      return field != nullptr ? field->ops->flag : opt->is_flag();
+    }
+    [[nodiscard]] bool is_option() const {
+      return field != nullptr ? !field->ops->flag : opt->is_option();
+    }
+
+    std::string_view name{};
+    OptBase* opt{nullptr};
+    FieldEntry const* field{nullptr};
+    bool negated{false};
+  };
+
+  void clear() {
+    slots.clear();
+    mask = 0;
+  }
+
+  void reserve(std::size_t count) {
+    std::size_t capacity = 8;
+    while (capacity < count * 2) {
+      capacity <<= 1;
+    }
+    slots.assign(capacity, Entry{});
+    mask = capacity - 1;
+  }
+
+  // returns the entry which already owns the name, nullptr on success
+  Entry const* insert(Entry const& entry) {
+    for (auto i = hash(entry.name) & mask;; i = (i + 1) & mask) {
+      auto& slot = slots[i];
+      if (slot.name.data() == nullptr) {
+        slot = entry;
+        return nullptr;
+      }
+      if (slot.name == entry.name) {
+        return &slot;
+      }
+    }
+  }
+
+  [[nodiscard]] Entry const* find(std::string_view name) const {
+    if (slots.empty()) {
+      return nullptr;
+    }
+    for (auto i = hash(name) & mask;; i = (i + 1) & mask) {
+      auto const& slot = slots[i];
+      if (slot.name.data() == nullptr) {
+        return nullptr;
+      }
+      if (slot.name == name) {
+        return &slot;
+      }
+    }
   }
 
-  template <typename T>
-  Positional(std::string const& name, T& bind)
-      : OptBase(OptBase::identity<T>{}, bind) {
-    add_option_name(name);
+ private:
+  // FNV-1a
+  static std::size_t hash(std::string_view name) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(h);
   }
 
-  template <typename T>
-  Positional(std::string const& name, OptBase::identity<T>)
-      : OptBase(OptBase::identity<T>{}) {
-    add_option_name(name);
-  }
-  bool can_set_value{true};
-  char delimiter{'\0'};
+  std::vector<Entry> slots{};
+  std::size_t mask{0};
 };
 
+class ParseResult;
+class ParserSpec;
+
 class ArgParser {
+  friend class ParseResult;
+  friend class ParserSpec;
+
  public:
   ArgParser() = default;
   explicit ArgParser(std::string desc) : description(std::move(desc)) {}
@@ -1112,124 +2602,143 @@ class ArgParser {
 
   template <typename T,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  Flag& add_flag(std::string const& flag_desc, T& bind) {
-    auto x = Flag::make_flag(flag_desc, bind);
-    auto p = x.get();
-    // TODO(shediao): check flag already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Flag& add_flag(std::string_view flag_desc, T& bind) {
+    return append(Flag::make_flag(flag_desc, bind));
   }
 
   template <typename T = bool,
             typename = std::enable_if_t<is_flag_bindable_value_v<T>>>
-  Flag& add_flag(std::string const& flag_desc) {
-    auto x = Flag::make_flag<T>(flag_desc);
-    auto p = x.get();
-    // TODO(shediao): check flag already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Flag& add_flag(std::string_view flag_desc) {
+    return append(Flag::make_flag<T>(flag_desc));
+  }
+
+  // A bool flag stored as bit of word, a std::bitset<N> or an unsigned
+  // integer a group of flags shares. A hit sets or clears the bit in place
+  // and several flags are tested at once against a mask of their bits.
+  // Like a bind_struct() field the bit is an entry of the name index, not
+  // an option: it is read from word, not looked up with get() or
+  // operator[], and reset() restores the value it has here. word must
+  // outlive the parser, the descriptor and help are copied.
+  template <typename Word,
+            typename = std::enable_if_t<is_flag_word_v<Word>>>
+  ArgParser& add_flag(std::string_view flag_desc,
+                      Word& word,
+                      std::size_t bit,
+                      std::string_view help = {}) {
+    if (bit >= flag_word_bits<Word>::value) {
+      throw std::logic_error("flag bit is out of range: " +
+                             std::to_string(bit));
+    }
+    for_each_field_name(flag_desc, true,
+                        [](std::string_view /*name*/, bool /*negated*/) {});
+    FieldEntry entry{&flag_bit_ops_of<Word>, &word,
+                     &flag_bit_values[test_flag_bit(word, bit) ? 1 : 0],
+                     field_text.emplace_back(flag_desc)};
+    if (!help.empty()) {
+      entry.help = field_text.emplace_back(help);
+    }
+    entry.bit = bit;
+    struct_fields.push_back(entry);
+    compiled = false;
+    return *this;
   }
   AliasFlag& add_alias_flag(
-      std::string const& flag_desc,
+      std::string_view flag_desc,
       std::pair<std::string, std::string> option_key_value) {
-    auto x = AliasFlag::make_flag(flag_desc, std::move(option_key_value));
-    auto* p = x.get();
-    // TODO(shediao): check flag already exists
-    all_options.push_back(std::move(x));
-    return *p;
+    return append(AliasFlag::make_flag(flag_desc, std::move(option_key_value)));
   }
 
   template <typename T,
             typename = std::enable_if_t<!is_need_split_v<T> &&
                                         is_option_bindable_value_v<T>>>
-  Option& add_option(std::string const& option_desc, T& bind) {
-    auto x = Option::make_option(option_desc, bind);
-    auto p = x.get();
-    // TODO(shediao): check option already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Option& add_option(std::string_view option_desc, T& bind) {
+    return append(Option::make_option(option_desc, bind));
   }
 
   template <typename T = std::string,
             typename = std::enable_if_t<!is_need_split_v<T> &&
                                         is_option_bindable_value_v<T>>>
-  Option& add_option(std::string const& option_desc) {
-    auto x = Option::make_option<T>(option_desc);
-    auto p = x.get();
-    // TODO(shediao): check option already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Option& add_option(std::string_view option_desc) {
+    return append(Option::make_option<T>(option_desc));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_need_split_v<T> &&
                                         is_option_bindable_value_v<T>>>
-  Option& add_option(std::string const& option_desc,
+  Option& add_option(std::string_view option_desc,
                      T& bind,
                      char delimiter = default_delimiter_v<T>) {
-    auto x = Option::make_option(option_desc, bind);
-    auto p = x.get();
-    all_options.push_back(std::move(x));
-    p->delimiter = delimiter;
-    return *p;
+    auto& p = append(Option::make_option(option_desc, bind));
+    p.delimiter = delimiter;
+    return p;
   }
 
   template <typename T = std::string,
             typename = std::enable_if_t<is_need_split_v<T> &&
                                         is_option_bindable_value_v<T>>>
-  Option& add_option(std::string const& option_desc,
+  Option& add_option(std::string_view option_desc,
                      char delimiter = default_delimiter_v<T>) {
-    auto x = Option::make_option<T>(option_desc);
-    auto p = x.get();
-    // TODO(shediao): check option already exists
-    all_options.push_back(std::move(x));
-    p->delimiter = delimiter;
-    return *p;
+    auto& p = append(Option::make_option<T>(option_desc));
+    p.delimiter = delimiter;
+    return p;
   }
 
   template <typename T,
             typename = std::enable_if_t<!is_need_split_v<T> &&
                                         is_position_bindable_value_v<T>>>
-  Positional& add_positional(std::string const& name, T& bind) {
-    auto x = Positional::make_positional(name, bind);
-    auto p = x.get();
-    // TODO(shediao): check positional already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Positional& add_positional(std::string_view name, T& bind) {
+    return append(Positional::make_positional(name, bind));
   }
   template <typename T = std::vector<std::string>,
             typename = std::enable_if_t<!is_need_split_v<T> &&
                                         is_position_bindable_value_v<T>>>
-  Positional& add_positional(std::string const& name) {
-    auto x = Positional::make_positional<T>(name);
-    auto p = x.get();
-    // TODO(shediao): check positional already exists
-    all_options.push_back(std::move(x));
-    return *p;
+  Positional& add_positional(std::string_view name) {
+    return append(Positional::make_positional<T>(name));
   }
 
   template <typename T,
             typename = std::enable_if_t<is_need_split_v<T> &&
                                         is_position_bindable_value_v<T>>>
-  Positional& add_positional(std::string const& name,
+  Positional& add_positional(std::string_view name,
                              T& bind,
                              char delimiter = default_delimiter_v<T>) {
-    auto x = Positional::make_positional(name, bind);
-    auto p = x.get();
-    all_options.push_back(std::move(x));
-    p->delimiter = delimiter;
-    return *p;
+    auto& p = append(Positional::make_positional(name, bind));
+    p.delimiter = delimiter;
+    return p;
   }
   template <typename T = std::vector<std::string>,
             typename = std::enable_if_t<is_need_split_v<T> &&
                                         is_position_bindable_value_v<T>>>
-  Positional& add_positional(std::string const& name,
+  Positional& add_positional(std::string_view name,
                              char delimiter = default_delimiter_v<T>) {
-    auto x = Positional::make_positional<T>(name);
-    auto p = x.get();
-    all_options.push_back(std::move(x));
-    p->delimiter = delimiter;
-    return *p;
+    auto& p = append(Positional::make_positional<T>(name));
+    p.delimiter = delimiter;
+    return p;
+  }
+
+  // Binds every entry of fields, a range of StructField<C>, to its member
+  // of object: a flag for a bool member, an option otherwise. parse()
+  // converts straight into the members and reset() restores the values
+  // object had here, kept in one copy of it. Fields are not options, they
+  // are read from object and not looked up with get() or operator[], and a
+  // parser with fields can't be frozen. object must outlive the parser,
+  // and so must the descriptors and help texts, which are not copied.
+  template <typename C, typename Fields>
+  ArgParser& bind_struct(C& object, Fields const& fields) {
+    for (auto const& entry : fields) {
+      for_each_field_name(entry.descriptor, entry.ops->flag,
+                          [](std::string_view /*name*/, bool /*negated*/) {});
+    }
+    auto copy = std::make_shared<C>(object);
+    struct_fields.reserve(struct_fields.size() + std::size(fields));
+    for (auto const& entry : fields) {
+      struct_fields.push_back(FieldEntry{entry.ops, entry.member(object),
+                                         entry.member(*copy), entry.descriptor,
+                                         entry.help});
+    }
+    struct_copies.push_back(std::move(copy));
+    compiled = false;
+    return *this;
   }
 
   std::string usage() {
@@ -1240,6 +2749,9 @@ class ArgParser {
         ss << " " << opt->short_usage();
       }
     }
+    for (auto const& field : struct_fields) {
+      ss << " " << field_usage(field, true);
+    }
     for (auto const& opt : all_options) {
       if (opt->is_positional()) {
         ss << " " << opt->short_usage();
@@ -1260,7 +2772,8 @@ class ArgParser {
       }
     }
 
-    if (any_of(begin(all_options), end(all_options),
+    if (!struct_fields.empty() ||
+        any_of(begin(all_options), end(all_options),
                [](auto& opt) { return !opt->is_positional(); })) {
       ss << "Options:\n";
       for (auto const& opt : all_options) {
@@ -1268,6 +2781,9 @@ class ArgParser {
           ss << opt->usage() << "\n\n";
         }
       }
+      for (auto const& field : struct_fields) {
+        ss << field_usage(field, false) << "\n\n";
+      }
     }
 
     return ss.str();
@@ -1277,48 +2793,341 @@ class ArgParser {
     unknown_option_as_start_of_positionals = true;
   }
 
+  // Builds the name index used by parse() and by name lookups, rejecting
+  // names registered twice. parse() compiles on demand; calling it up front
+  // surfaces registration mistakes before any command line is seen.
+  ArgParser& compile() {
+    if (compiled) {
+      if (finished_generation !=
+          OptBase::finish_generation.load(std::memory_order_relaxed)) {
+        collect_finished_options();
+      }
+      return *this;
+    }
+    // positional names are not options, see find_option()
+    std::size_t name_count = 0;
+    for (auto const& opt : all_options) {
+      if (opt->is_positional()) {
+        continue;
+      }
+      name_count += opt->option_names().size();
+      if (opt->is_flag()) {
+        name_count += static_cast<Flag*>(opt.get())->negate_flag_names.size();
+      }
+    }
+    for (auto const& field : struct_fields) {
+      for_each_field_name(
+          field.descriptor, field.ops->flag,
+          [&name_count](std::string_view /*name*/, bool /*negated*/) {
+            name_count++;
+          });
+    }
+    name_index.reserve(name_count);
+    short_index.fill(ShortEntry{});
+    for (auto const& opt : all_options) {
+      if (opt->is_positional()) {
+        continue;
+      }
+      for (auto const& name : opt->option_names()) {
+        index_name({name, opt.get(), nullptr, false});
+      }
+      if (opt->is_flag()) {
+        for (auto const& name :
+             static_cast<Flag*>(opt.get())->negate_flag_names) {
+          index_name({name, opt.get(), nullptr, true});
+        }
+      }
+    }
+    for (auto const& field : struct_fields) {
+      for_each_field_name(field.descriptor, field.ops->flag,
+                          [this, &field](std::string_view name, bool negated) {
+                            index_name({name, nullptr, &field, negated});
+                          });
+    }
+    for (auto const& opt : all_options) {
+      if (opt->is_alias_flag()) {
+        auto* alias = static_cast<AliasFlag*>(opt.get());
+        auto const* entry = name_index.find(alias->option_name);
+        if (entry == nullptr || entry->opt == nullptr ||
+            !entry->opt->is_option()) {
+          throw std::logic_error("alias flag refers to an unknown option: " +
+                                 alias->option_name);
+        }
+        alias->option = entry->opt;
+      }
+    }
+    positionals.clear();
+    for (std::size_t i = 0; i < all_options.size(); i++) {
+      all_options[i]->index = i;
+    }
+    for (auto const& opt : all_options) {
+      if (opt->is_positional()) {
+        positionals.push_back(static_cast<Positional*>(opt.get()));
+      }
+    }
+    collect_finished_options();
+    compiled = true;
+    return *this;
+  }
+
+  // Tokens are viewed in place in argv; only values stored into a
+  // std::string binding are copied out of it. A std::string_view binding
+  // views argv, which must outlive it.
   void parse(int argc, const char* const* argv) {
     add_help_flag_if_needed();
-    std::vector<std::string> command_line_args{argv, argv + argc};
+    compile();
+
+    if (argc > 0 && program_name.empty()) {
+      if (std::string_view const first{*argv};
+          !first.empty() && first[0] != '-') {
+        auto const slash = first.find_last_of("/\\");
+        program_name = std::string(
+            slash == std::string_view::npos ? first : first.substr(slash + 1));
+      }
+    }
+
+    parse_args(argc, argv, [this](OptBase const& opt) -> OptState& {
+      return all_options[opt.index]->state;
+    });
+  }
+
+  // Compiles the parser and returns a read-only view on it, see ParserSpec.
+  ParserSpec freeze();
+
+  // Converts the values of all lazy options, see OptBase::lazy().
+  void validate() const {
+    for (auto const& opt : all_options) {
+      opt->state.validate();
+    }
+  }
+
+  // Restores every option to its default (or the value its variable had
+  // when bound) so the parser can parse again. Allocated capacity is kept,
+  // a steady-state re-parse of the same grammar barely allocates.
+  ArgParser& reset() {
+    for (auto const& opt : all_options) {
+      opt->reset();
+    }
+    for (auto const& field : struct_fields) {
+      field.ops->reset(field);
+      field.hit = false;
+    }
+    return *this;
+  }
+
+  std::optional<OptBase*> get(std::string const& f) {
+    compile();
+    if (auto* opt = find_option(f)) {
+      return opt;
+    }
+    return std::nullopt;
+  }
+
+  OptBase& operator[](std::string const& f) {
+    auto x = get(f);
+    if (x.has_value()) {
+      return *(x.value());
+    }
+    throw option_not_found{};
+  }
+
+ private:
+  template <typename T>
+  T& append(std::unique_ptr<T> opt) {
+    auto* p = opt.get();
+    all_options.push_back(std::move(opt));
+    compiled = false;
+    return *p;
+  }
+
+  // Calls f(name, negated) for every name of a bind_struct() descriptor,
+  // checked like the names of add_flag() and add_option(); only a flag
+  // takes negated names.
+  template <typename F>
+  static void for_each_field_name(std::string_view descriptor,
+                                  bool flag,
+                                  F const& f) {
+    char const* const kind = flag ? "flag" : "option";
+    bool any{false};
+    StringUtil::for_each_part(descriptor, ',', [&](std::string_view name) {
+      any = true;
+      name = StringUtil::trim(name);
+      bool const negated = flag && StringUtil::startswith(name, "!");
+      if (negated) {
+        name.remove_prefix(1);
+      }
+      name = StringUtil::strip_dashes(name);
+      if (name.empty()) {
+        throw std::logic_error(std::string(kind) + " item name is empty");
+      }
+      if (flag && name[0] == '-') {
+        throw std::logic_error("flag item name is startswith '-'");
+      }
+      f(name, negated);
+    });
+    if (!any) {
+      throw std::logic_error(std::string(kind) + " name is empty");
+    }
+  }
+
+  // the help of a field, written like Flag::usage() and Option::usage() or
+  // like their short_usage()
+  static std::string field_usage(FieldEntry const& field, bool short_form) {
+    std::ostringstream ss;
+    ss << (short_form ? "[" : "  ");
+    char const* between = field.ops->flag ? ", " : ",";
+    if (short_form) {
+      between = "|";
+    }
+    char const* separator = "";
+    for_each_field_name(field.descriptor, field.ops->flag,
+                        [&](std::string_view name, bool negated) {
+                          if (!negated) {
+                            ss << separator << (name.size() == 1 ? "-" : "--")
+                               << name;
+                            separator = between;
+                          }
+                        });
+    if (!field.ops->flag) {
+      ss << (short_form ? " <" : "=<") << field.ops->type_placeholder()
+         << ">";
+    }
+    if (short_form) {
+      ss << "]";
+    } else if (!field.help.empty()) {
+      ss << "\n            " << field.help;
+    }
+    return ss.str();
+  }
+
+  // Lists the options with a finish handler. compile() lists them again
+  // when OptBase::finish_generation shows that bind() changed a handler.
+  void collect_finished_options() {
+    finished_generation =
+        OptBase::finish_generation.load(std::memory_order_relaxed);
+    finished_options.clear();
+    for (auto const& opt : all_options) {
+      if (opt->finish != nullptr) {
+        finished_options.push_back(opt.get());
+      }
+    }
+  }
+
+  // The flag or option named name, else the positional. Positionals have
+  // their own names, which may also be the name of a flag or option.
+  OptBase* find_option(std::string_view name) const {
+    if (auto const* entry = name_index.find(name);
+        entry != nullptr && entry->opt != nullptr) {
+      return entry->opt;
+    }
+    for (auto* positional : positionals) {
+      auto const& names = positional->option_names();
+      if (std::find(names.begin(), names.end(), name) != names.end()) {
+        return positional;
+      }
+    }
+    return nullptr;
+  }
+
+  void index_name(NameIndex::Entry const& named) {
+    auto const name = named.name;
+    if (name_index.insert(named) != nullptr) {
+      name_index.clear();
+      short_index.fill(ShortEntry{});
+      throw std::logic_error("flag or option already exists: " +
+                             std::string(name));
+    }
+    auto const* opt = named.opt;
+    auto const negated = named.negated;
+    if (name.size() != 1) {
+      return;
+    }
+    auto& entry = short_index[static_cast<unsigned char>(name[0])];
+    entry.opt = named.opt;
+    entry.field = named.field;
+    if (opt == nullptr && !named.field->ops->flag) {
+      entry.kind = ShortKind::FIELD_OPTION;
+    } else if (opt == nullptr) {
+      entry.kind =
+          negated ? ShortKind::NEGATED_FIELD_FLAG : ShortKind::FIELD_FLAG;
+    } else if (opt->is_option()) {
+      entry.kind = ShortKind::OPTION;
+    } else if (negated) {
+      entry.kind = ShortKind::NEGATED_FLAG;
+    } else if (opt->is_alias_flag()) {
+      entry.kind = ShortKind::ALIAS_FLAG;
+    } else {
+      entry.kind = ShortKind::FLAG;
+    }
+  }
 
-    if (command_line_args.empty()) {
+  // The parse loop. It only reads the compiled parser; the state every hit
+  // updates is looked up with state_of(OptBase const&) -> OptState&.
+  template <typename StateOf>
+  void parse_args(int argc,
+                  const char* const* argv,
+                  StateOf const& state_of) const {
+    if (argc <= 0) {
       return;
     }
 
-    auto current = command_line_args.begin();
+    auto const* const args_end = argv + argc;
+    auto const* current = argv;
 
-    if (auto& first = *command_line_args.begin();
+    if (std::string_view const first{*current};
         !first.empty() && first[0] != '-') {
-      if (program_name.empty()) {
-        auto it = std::find_if(rbegin(first), rend(first),
-                               [](char c) { return c == '/' || c == '\\'; });
-        program_name = std::string(it.base(), first.end());
-      }
       // 0 ==> skip program file path
-      current = std::next(command_line_args.begin());
+      current++;
     }
 
-    auto current_position_it =
-        find_if(begin(all_options), end(all_options),
-                [](auto& o) { return o->is_positional(); });
+    auto hit = [&state_of](OptBase const& opt, std::string_view val,
+                           bool negated) {
+      auto& state = state_of(opt);
+      if (!opt.is_positional()) {
+        state.hit_count++;
+      }
+      opt.on_hit(opt, state, val, negated);
+    };
+    // a bind_struct() field or flag bit, written straight into its member
+    auto hit_field = [](FieldEntry const& field, std::string_view val,
+                        bool negated) {
+      field.ops->hit(field, val, negated);
+      field.hit = true;
+    };
+    // the value of a long option or field
+    auto hit_value = [&](NameIndex::Entry const& entry, std::string_view val) {
+      if (entry.field != nullptr) {
+        hit_field(*entry.field, val, false);
+      } else {
+        hit(*entry.opt, val, false);
+      }
+    };
+    auto hit_flag = [&hit](OptBase const& flag, bool negated) {
+      hit(flag, {}, negated);
+      if (flag.is_alias_flag()) {
+        auto const& alias = static_cast<AliasFlag const&>(flag);
+        hit(*alias.option, alias.option_value, false);
+      }
+    };
+    auto current_position_it = positionals.cbegin();
+    auto hit_positional = [&](std::string_view arg) {
+      while (current_position_it != positionals.cend() &&
+             !state_of(**current_position_it).can_set_value) {
+        ++current_position_it;
+      }
+      if (current_position_it == positionals.cend()) {
+        throw invalid_argument("unrecognized arguments: " + std::string(arg));
+      }
+      hit(**current_position_it, arg, false);
+    };
 
-    while (current != command_line_args.end()) {
-      auto next = std::next(current);
+    while (current != args_end) {
+      auto const* next = current + 1;
 
-      auto const& curr_arg = *current;
+      std::string_view const curr_arg{*current};
 
       if (StringUtil::is_position_arg(curr_arg)) {
-        while (current_position_it != all_options.end() &&
-               !(dynamic_cast<Positional*>(current_position_it->get()))
-                    ->can_set_value) {
-          current_position_it =
-              find_if(std::next(current_position_it), end(all_options),
-                      [](auto& o) { return o->is_positional(); });
-        }
-        if (current_position_it == all_options.end()) {
-          throw invalid_argument("unrecognized arguments: " + curr_arg);
-        }
-        (*current_position_it)->hit("", curr_arg);
+        hit_positional(curr_arg);
         current = next;
       } else if (StringUtil::is_dash_dash(curr_arg)) {
         // --
@@ -1328,78 +3137,80 @@ class ArgParser {
         break;
       } else if (StringUtil::is_short_opt(curr_arg)) {
         // short
-        auto short_p = curr_arg.begin() + 1;
-        while (short_p != curr_arg.end()) {
-          if (auto short_flag = get_flag(*short_p); short_flag.has_value()) {
-            (*short_flag)->hit(*short_p);
-            if ((*short_flag)->is_alias_flag()) {
-              auto* alis_flag = dynamic_cast<AliasFlag*>(*short_flag);
-              if (auto option = get_option(alis_flag->option_name);
-                  option.has_value()) {
-                option.value()->hit(alis_flag->option_name,
-                                    alis_flag->option_value);
-              } else {
-                UNREACHABLE();
-              }
-            }
-            short_p++;
-          } else if (auto short_option = get_option(*short_p);
-                     short_option.has_value()) {
-            if (short_p + 1 != curr_arg.end()) {
-              (*short_option)
-                  ->hit(*short_p, std::string(short_p + 1, curr_arg.end()));
-              short_p = curr_arg.end();
+        std::size_t short_i = 1;
+        while (short_i < curr_arg.size()) {
+          auto const short_name = curr_arg[short_i];
+          auto const& entry =
+              short_index[static_cast<unsigned char>(short_name)];
+          if (entry.kind == ShortKind::FLAG ||
+              entry.kind == ShortKind::NEGATED_FLAG ||
+              entry.kind == ShortKind::ALIAS_FLAG) {
+            hit_flag(*entry.opt, entry.kind == ShortKind::NEGATED_FLAG);
+            short_i++;
+          } else if (entry.kind == ShortKind::FIELD_FLAG ||
+                     entry.kind == ShortKind::NEGATED_FIELD_FLAG) {
+            hit_field(*entry.field, {},
+                      entry.kind == ShortKind::NEGATED_FIELD_FLAG);
+            short_i++;
+          } else if (entry.kind == ShortKind::OPTION ||
+                     entry.kind == ShortKind::FIELD_OPTION) {
+            std::string_view value;
+            if (short_i + 1 != curr_arg.size()) {
+              value = curr_arg.substr(short_i + 1);
             } else {
-              if (next == command_line_args.end()) {
-                throw invalid_argument("option requires an argument: -" +
-                                       std::string(1, *short_p));
-              }
-              if ((!next->empty() && (*next)[0] == '-')) {
+              // an empty argument starts with '\0' and is a valid value
+              if (next == args_end || (*next)[0] == '-') {
                 throw invalid_argument("option requires an argument: -" +
-                                       std::string(1, *short_p));
+                                       std::string(1, short_name));
               }
-              (*short_option)->hit(*short_p, *next);
-              short_p = curr_arg.end();
-              next = std::next(next);
+              value = *next;
+              next++;
+            }
+            if (entry.kind == ShortKind::OPTION) {
+              hit(*entry.opt, value, false);
+            } else {
+              hit_field(*entry.field, value, false);
             }
+            short_i = curr_arg.size();
           } else {
             if (unknown_option_as_start_of_positionals) {
               break;
             }
             throw invalid_argument("invalid option: -" +
-                                   std::string(1, *short_p));
+                                   std::string(1, short_name));
           }
         }
         current = next;
       } else if (StringUtil::is_long_opt(curr_arg)) {
         // long
-        if (auto i = curr_arg.find('=', 2); i != std::string::npos) {
-          std::string const option = curr_arg.substr(2, i - 2);
-          if (auto long_opt = get_option(option); long_opt.has_value()) {
-            (*long_opt)->hit(option, curr_arg.substr(i + 1));
+        if (auto i = curr_arg.find('=', 2); i != std::string_view::npos) {
+          auto const option = curr_arg.substr(2, i - 2);
+          if (auto const* entry = name_index.find(option);
+              entry != nullptr && entry->is_option()) {
+            hit_value(*entry, curr_arg.substr(i + 1));
           } else {
-            throw invalid_argument("invalid option: --" + option);
+            throw invalid_argument("invalid option: --" + std::string(option));
           }
         } else {
-          std::string const option = curr_arg.substr(2);
-          if (auto long_flag = get_flag(option); long_flag.has_value()) {
-            (*long_flag)->hit(option);
-          } else if (auto long_opt = get_option(option); long_opt.has_value()) {
-            if (std::next(current) == command_line_args.end()) {
-              throw invalid_argument("option requires an argument: --" +
-                                     option);
-            }
-            if (!next->empty() && (*next)[0] == '-') {
+          auto const option = curr_arg.substr(2);
+          auto const* entry = name_index.find(option);
+          if (entry != nullptr && entry->field != nullptr &&
+              entry->is_flag()) {
+            hit_field(*entry->field, {}, entry->negated);
+          } else if (entry != nullptr && entry->is_flag()) {
+            hit_flag(*entry->opt, entry->negated);
+          } else if (entry != nullptr && entry->is_option()) {
+            if (next == args_end || (*next)[0] == '-') {
               throw invalid_argument("option requires an argument: --" +
-                                     option);
+                                     std::string(option));
             }
-            (*long_opt)->hit(option, *next);
-            next = std::next(next);
+            hit_value(*entry, *next);
+            next++;
           } else {
             if (unknown_option_as_start_of_positionals) {
               break;
             }
-            throw invalid_argument("invalid option: --" + option);
+            throw invalid_argument("invalid option: --" + std::string(option));
           }
         }
         current = next;
@@ -1408,42 +3219,28 @@ class ArgParser {
       }
     }
 
-    for (; current != command_line_args.end(); current++) {
-      while (!(dynamic_cast<Positional*>(current_position_it->get()))
-                  ->can_set_value &&
-             current_position_it != all_options.end()) {
-        current_position_it =
-            find_if(std::next(current_position_it), end(all_options),
-                    [](auto& o) { return o->is_positional(); });
-      }
-      if (current_position_it == all_options.end()) {
-        throw invalid_argument("unrecognized arguments: " + *current);
-      }
-      (*current_position_it)->hit("", *current);
+    for (; current != args_end; current++) {
+      hit_positional(*current);
     }
-  }
 
-  std::optional<OptBase*> get(std::string const& f) {
-    auto it = find_if(begin(all_options), end(all_options),
-                      [&f](auto const& f1) { return f1->contains(f); });
-    if (it != end(all_options)) {
-      return (*it).get();
+    // a lazy option is finished when its values are converted
+    for (auto const* opt : finished_options) {
+      auto& state = state_of(*opt);
+      if (state.hit_count > 0 && state.pending.empty()) {
+        opt->finish(state);
+      }
     }
-    return std::nullopt;
-  }
-
-  OptBase& operator[](std::string const& f) {
-    auto x = get(f);
-    if (x.has_value()) {
-      return *(x.value());
+    for (auto const& field : struct_fields) {
+      if (field.hit && field.ops->finish != nullptr) {
+        field.ops->finish(field.member);
+      }
     }
-    throw option_not_found{};
   }
 
- private:
   void add_help_flag_if_needed() {
-    auto has_h_flag = get_flag("h").has_value();
-    auto has_help_flag = get_flag("help").has_value();
+    compile();
+    auto has_h_flag = name_index.find("h") != nullptr;
+    auto has_help_flag = name_index.find("help") != nullptr;
     const char* msg = "display this help and exit";
     if (!has_h_flag && !has_help_flag) {
       add_flag("-h,--help").help(msg);
@@ -1458,38 +3255,357 @@ class ArgParser {
       return;
     }
   }
-  std::optional<Flag*> get_flag(char const flag) {
-    return get_flag(std::string(1, flag));
+
+  std::string description{};
+  std::string program_name{};
+  bool unknown_option_as_start_of_positionals{false};
+
+  // single character flags and options, indexed by the character itself so
+  // that a short cluster like -abc costs one table load per character.
+  enum class ShortKind : unsigned char {
+    NONE,
+    FLAG,
+    NEGATED_FLAG,
+    ALIAS_FLAG,
+    OPTION,
+    FIELD_FLAG,
+    NEGATED_FIELD_FLAG,
+    FIELD_OPTION
+  };
+  struct ShortEntry {
+    ShortKind kind{ShortKind::NONE};
+    OptBase* opt{nullptr};
+    FieldEntry const* field{nullptr};
+  };
+
+  std::vector<std::unique_ptr<OptBase>> all_options{};
+  // the members bound by bind_struct() and the bits bound by add_flag(),
+  // the copies of the bound objects and of the bit descriptors
+  std::vector<FieldEntry> struct_fields{};
+  std::vector<std::shared_ptr<void const>> struct_copies{};
+  std::deque<std::string> field_text{};
+  NameIndex name_index{};
+  std::array<ShortEntry, 256> short_index{};
+  std::vector<Positional*> positionals{};
+  // the options with an OptBase::finish_handler, as of finished_generation
+  std::vector<OptBase*> finished_options{};
+  std::size_t finished_generation{0};
+  bool compiled{false};
+};
+
+template <typename M>
+struct member_pointer_traits;
+template <typename C, typename T>
+struct member_pointer_traits<T C::*> {
+  using class_type = C;
+  using value_type = T;
+};
+
+// One entry of a table for ArgParser::bind_struct(): the descriptor and
+// help of a flag or option, the operations of the member type and where
+// the member is in a C. Entries are made with field<&C::member>().
+template <typename C>
+struct StructField {
+  std::string_view descriptor;
+  std::string_view help;
+  FieldOps const* ops;
+  void* (*member)(C& object);
+};
+
+// The table entry of the member M, a flag for a bool member and an option
+// otherwise. The kind and conversion of the value are chosen at compile
+// time, a table of them can be constexpr:
+//
+//   constexpr argparse::StructField<Config> config_fields[] = {
+//       argparse::field<&Config::verbose>("v,verbose"),
+//       argparse::field<&Config::jobs>("j,jobs", "run N jobs at once")};
+template <auto M>
+constexpr auto field(std::string_view descriptor, std::string_view help = {}) {
+  using traits = member_pointer_traits<decltype(M)>;
+  using C = typename traits::class_type;
+  using T = typename traits::value_type;
+  static_assert(is_option_bindable_value_v<T>,
+                "the member can't be bound to a flag or option");
+  return StructField<C>{descriptor, help, &field_ops_of<T>,
+                        [](C& object) -> void* { return &(object.*M); }};
+}
+
+// The values of one ParserSpec::parse() call, looked up by name like the
+// options of an ArgParser. It refers to the parser it was parsed with,
+// which must outlive it.
+class ParseResult {
+ public:
+  std::optional<OptState const*> get(std::string const& name) const {
+    if (auto const* opt = parser->find_option(name)) {
+      return &states[opt->index];
+    }
+    return std::nullopt;
   }
-  std::optional<Flag*> get_flag(std::string const& flag) {
-    auto it = find_if(
-        begin(all_options), end(all_options),
-        [flag](auto const& f) { return f->is_flag() && f->contains(flag); });
-    if (it != end(all_options)) {
-      return dynamic_cast<Flag*>((*it).get());
+
+  OptState const& operator[](std::string const& name) const {
+    auto x = get(name);
+    if (x.has_value()) {
+      return *(x.value());
     }
-    return {};
+    throw option_not_found{};
   }
-  std::optional<Option*> get_option(char const opt) {
-    return get_option(std::string(1, opt));
+
+  // Converts the values of all lazy options, see OptBase::lazy().
+  void validate() const {
+    for (auto const& state : states) {
+      state.validate();
+    }
   }
-  std::optional<Option*> get_option(std::string const& opt) {
-    auto it = find_if(
-        begin(all_options), end(all_options),
-        [opt](auto const& f) { return f->is_option() && f->contains(opt); });
-    if (end(all_options) != it) {
-      return dynamic_cast<Option*>((*it).get());
+
+ private:
+  friend class ParserSpec;
+
+  explicit ParseResult(ArgParser const& parser) : parser(&parser) {
+    states.reserve(parser.all_options.size());
+    for (auto const& opt : parser.all_options) {
+      states.push_back(opt->initial_state());
     }
-    return {};
   }
 
-  std::string description{};
-  std::string program_name{};
-  bool unknown_option_as_start_of_positionals{false};
+  template <typename T>
+  friend class Handle;
 
-  std::vector<std::unique_ptr<OptBase>> all_options{};
+  ArgParser const* parser;
+  std::vector<OptState> states{};
+};
+
+// A typed reference to a flag, option or positional holding or bound to a
+// T, made from what add_flag(), add_option() and add_positional() return:
+//
+//   argparse::Handle<int> verbose = parser.add_flag("v,!q");
+//   ...
+//   if (verbose.get() > 1) { ... }
+//
+// get() skips the name lookup and the checked variant access of
+// parser["v"].get<int>(). The type is checked and the value resolved once,
+// when the handle is made; get() then only checks for values a lazy option
+// has yet to convert and loads the value pointer. The parser must outlive
+// the handle, and the option must only be re-bound through the handle.
+template <typename T>
+class Handle {
+  static_assert(is_bindable_value_v<T>, "T is not a bindable value type");
+
+ public:
+  Handle(OptBase& opt) : opt(&opt), target(opt.state.target_if<T>()) {
+    if (target == nullptr) {
+      throw bad_value_access("handle type mismatch: " +
+                             opt.state.value_type_name() + " => " +
+                             bindable_type_info<T>::name());
+    }
+  }
+
+  // the value of the last ArgParser::parse()
+  T const& get() const {
+    opt->state.validate();
+    return *target;
+  }
+  [[nodiscard]] int count() const { return opt->state.count(); }
+
+  // the value in a result of the ParserSpec frozen from the same parser
+  T const& get(ParseResult const& result) const {
+    return value_of(result.states[opt->index]);
+  }
+  [[nodiscard]] int count(ParseResult const& result) const {
+    return result.states[opt->index].count();
+  }
+
+  OptBase& option() const { return *opt; }
+
+  // OptBase::bind() for the option, with the handle following the variable
+  Handle& bind(T& var) {
+    opt->bind(var);
+    target = &var;
+    return *this;
+  }
+
+ private:
+  static T const& value_of(OptState const& state) {
+    state.validate();
+    return *state.target_if<T>();
+  }
+
+  OptBase* opt;
+  // the value opt holds or is bound to
+  T const* target;
+};
+
+// The outcome of one command line of ParserSpec::parse_batch(): either the
+// parsed values or the exception parse() threw for it.
+struct BatchResult {
+  std::optional<ParseResult> result{};
+  std::exception_ptr error{};
+};
+
+// Hands out the indices [0, count) to a fixed number of workers. Each
+// worker starts on its own contiguous share and, once that is drained,
+// steals the back half of the largest share left, so that batches mixing
+// long and short command lines still finish together.
+class BatchScheduler {
+ public:
+  BatchScheduler(std::size_t count, unsigned workers) : shares(workers) {
+    for (unsigned w = 0; w < workers; w++) {
+      shares[w].begin = count * w / workers;
+      shares[w].end = count * (w + 1) / workers;
+    }
+  }
+
+  // the next index for worker, false once there is no work left anywhere
+  bool next(unsigned worker, std::size_t& index) {
+    do {
+      std::lock_guard<std::mutex> lock(shares[worker].mutex);
+      if (shares[worker].begin != shares[worker].end) {
+        index = shares[worker].begin++;
+        return true;
+      }
+    } while (steal(worker));
+    return false;
+  }
+
+ private:
+  struct Share {
+    std::mutex mutex;
+    std::size_t begin{0};
+    std::size_t end{0};
+  };
+
+  bool steal(unsigned worker) {
+    for (;;) {
+      unsigned victim = worker;
+      std::size_t most = 0;
+      for (unsigned w = 0; w < shares.size(); w++) {
+        std::lock_guard<std::mutex> lock(shares[w].mutex);
+        if (w != worker && shares[w].end - shares[w].begin > most) {
+          most = shares[w].end - shares[w].begin;
+          victim = w;
+        }
+      }
+      if (victim == worker) {
+        return false;
+      }
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      {
+        std::lock_guard<std::mutex> lock(shares[victim].mutex);
+        auto const remaining = shares[victim].end - shares[victim].begin;
+        if (remaining == 0) {
+          continue;
+        }
+        end = shares[victim].end;
+        begin = end - (remaining + 1) / 2;
+        shares[victim].end = begin;
+      }
+      std::lock_guard<std::mutex> lock(shares[worker].mutex);
+      shares[worker].begin = begin;
+      shares[worker].end = end;
+      return true;
+    }
+  }
+
+  std::vector<Share> shares;
+};
+
+// A read-only view on a compiled ArgParser. Its parse() leaves the parser
+// and the variables bound to it untouched and returns the values in a
+// ParseResult, so any number of threads can parse through one spec at
+// once. The ArgParser must outlive the spec and must not be changed while
+// the spec is in use.
+class ParserSpec {
+ public:
+  [[nodiscard]] ParseResult parse(int argc, const char* const* argv) const {
+    ParseResult result(*parser);
+    parser->parse_args(argc, argv,
+                       [&result](OptBase const& opt) -> OptState& {
+                         return result.states[opt.index];
+                       });
+    return result;
+  }
+
+  // Parses every command line of argvs, a random access range of argv
+  // containers such as std::vector<std::vector<const char*>>, on the given
+  // number of threads (0: one per hardware thread). The results are in the
+  // order of argvs.
+  template <typename Range>
+  [[nodiscard]] std::vector<BatchResult> parse_batch(
+      Range const& argvs,
+      unsigned threads = 0) const {
+    auto const first = std::begin(argvs);
+    auto const count =
+        static_cast<std::size_t>(std::distance(first, std::end(argvs)));
+    std::vector<BatchResult> results(count);
+    auto parse_one = [this, &first, &results](std::size_t i) {
+      auto const& args = first[static_cast<std::ptrdiff_t>(i)];
+      try {
+        results[i].result.emplace(
+            parse(static_cast<int>(std::size(args)), std::data(args)));
+      } catch (...) {
+        results[i].error = std::current_exception();
+      }
+    };
+
+    if (threads == 0) {
+      threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(
+        std::min<std::size_t>(threads, std::max<std::size_t>(count, 1)));
+    if (threads == 1) {
+      for (std::size_t i = 0; i < count; i++) {
+        parse_one(i);
+      }
+      return results;
+    }
+
+    BatchScheduler scheduler(count, threads);
+    auto work = [&scheduler, &parse_one](unsigned worker) {
+      std::size_t i = 0;
+      while (scheduler.next(worker, i)) {
+        parse_one(i);
+      }
+    };
+    std::vector<std::thread> workers;
+    auto join_all = [&workers] {
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    };
+    try {
+      workers.reserve(threads - 1);
+      for (unsigned w = 1; w < threads; w++) {
+        workers.emplace_back(work, w);
+      }
+    } catch (...) {
+      // a joinable std::thread must not be destroyed
+      join_all();
+      throw;
+    }
+    work(0);
+    join_all();
+    return results;
+  }
+
+ private:
+  friend class ArgParser;
+
+  explicit ParserSpec(ArgParser const& parser) : parser(&parser) {}
+
+  ArgParser const* parser;
 };
 
+inline ParserSpec ArgParser::freeze() {
+  if (!struct_fields.empty()) {
+    // a spec parse has nowhere to keep field values but the bound object
+    throw std::logic_error(
+        "a parser with bind_struct() fields or flag bits can't freeze");
+  }
+  add_help_flag_if_needed();
+  compile();
+  return ParserSpec(*this);
+}
+
 }  // namespace argparse
 
 #endif  // ARGPARSE_CPP_H_
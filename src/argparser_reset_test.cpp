@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+#include "argparse.hpp"
+
+namespace {
+std::size_t allocations{0};
+}
+
+void* operator new(std::size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t /*size*/) noexcept {
+  std::free(p);
+}
+
+TEST(ArgParser, reset) {
+  argparse::ArgParser parser;
+  int verbose{0};
+  std::vector<std::string> files;
+  parser.add_flag("v,!q", verbose);
+  parser.add_flag("a,all");
+  parser.add_option("o,output").set_default("a.out");
+  parser.add_option<std::vector<int>>("n");
+  parser.add_positional("files", files);
+
+  std::vector<const char*> cmd{"test", "-vva",  "--output=result", "-n1",
+                               "-n",   "2",     "file0",           "file1"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(2, verbose);
+  EXPECT_EQ("result", parser["o"].get<std::string>());
+  EXPECT_EQ((std::vector<int>{1, 2}), parser["n"].get<std::vector<int>>());
+  EXPECT_EQ(2U, files.size());
+
+  parser.reset();
+  EXPECT_EQ(0, verbose);
+  EXPECT_EQ(0, parser["v"].count());
+  EXPECT_FALSE(parser["a"].get<bool>());
+  EXPECT_EQ("a.out", parser["o"].get<std::string>());
+  EXPECT_TRUE(parser["n"].get<std::vector<int>>().empty());
+  EXPECT_TRUE(files.empty());
+
+  std::vector<const char*> cmd2{"test", "-q", "file2"};
+  ASSERT_NO_THROW(parser.parse(cmd2.size(), cmd2.data()));
+  EXPECT_EQ(-1, verbose);
+  EXPECT_EQ("a.out", parser["o"].get<std::string>());
+  EXPECT_EQ((std::vector<std::string>{"file2"}), files);
+}
+
+TEST(ArgParser, reset_keeps_capacity) {
+  argparse::ArgParser parser;
+  std::string output;
+  std::vector<int> numbers;
+  std::vector<std::string> files;
+  parser.add_flag("v,!q");
+  parser.add_option("o,output", output);
+  parser.add_option("n", numbers);
+  parser.add_positional("files", files);
+
+  std::vector<const char*> cmd{
+      "test",   "-vvq", "--output=/tmp/some/long/path", "-n1", "-n", "2",
+      "short0", "short1"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  auto const before = allocations;
+  for (int i = 0; i < 10000; i++) {
+    parser.reset();
+    parser.parse(cmd.size(), cmd.data());
+  }
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_EQ("/tmp/some/long/path", output);
+  EXPECT_EQ((std::vector<int>{1, 2}), numbers);
+  EXPECT_EQ((std::vector<std::string>{"short0", "short1"}), files);
+}
+
+TEST(ArgParser, bool_keywords_do_not_allocate) {
+  argparse::ArgParser parser;
+  bool color{false};
+  parser.add_option("color", color);
+
+  std::vector<const char*> cmd{"test", "--color=Yes", "--color=OFF",
+                               "--color=True"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  auto const before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    parser.reset();
+    parser.parse(cmd.size(), cmd.data());
+  }
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_TRUE(color);
+}
+
+TEST(ArgParser, map_insertion_allocations) {
+  argparse::ArgParser parser;
+  std::map<std::string, std::string> properties;
+  parser.add_option("D", properties);
+
+  std::vector<std::string> args;
+  for (int i = 0; i < 1000; i++) {
+    args.push_back("-Dsome.long.property.key." + std::to_string(i) +
+                   "=some long property value " + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"test"};
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+  ASSERT_NO_THROW(parser.parse(1, cmd.data()));
+
+  // the key, the value and the map node
+  auto const before = allocations;
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(3 * args.size(), allocations - before);
+  EXPECT_EQ(1000U, properties.size());
+  EXPECT_EQ("some long property value 7",
+            properties["some.long.property.key.7"]);
+}
+
+TEST(ArgParser, string_view_positionals_do_not_allocate) {
+  argparse::ArgParser parser;
+  std::vector<std::string_view> files;
+  parser.add_positional("files", files);
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < 1000; i++) {
+    paths.push_back("/some/long/directory/name/file" + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"test"};
+  for (auto const& path : paths) {
+    cmd.push_back(path.c_str());
+  }
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  auto const before = allocations;
+  parser.reset();
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(0U, allocations - before);
+  ASSERT_EQ(paths.size(), files.size());
+  EXPECT_EQ(paths[7].c_str(), files[7].data());
+}
+
+TEST(ArgParser, unordered_map_keeps_buckets) {
+  argparse::ArgParser parser;
+  std::unordered_map<std::string_view, std::string_view> labels;
+  parser.add_option("label", labels);
+
+  std::vector<std::string> args;
+  for (int i = 0; i < 1000; i++) {
+    args.push_back("--label=key" + std::to_string(i) + "=value");
+  }
+  std::vector<const char*> cmd{"test"};
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  // one node per entry, no rehash
+  auto const before = allocations;
+  parser.reset();
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(args.size(), allocations - before);
+  EXPECT_EQ(1000U, labels.size());
+}
+
+TEST(ArgParser, unordered_map_grows_like_the_container) {
+  using labels = std::unordered_map<std::string_view, std::string_view>;
+  argparse::ArgParser parser;
+  labels parsed;
+  parser.add_option("label", parsed);
+  std::vector<const char*> cmd{"test"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  parser.reset();
+
+  std::vector<std::string> args;
+  for (int i = 0; i < 100000; i++) {
+    args.push_back("--label=k" + std::to_string(i) + "=v");
+  }
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+
+  // the nodes and as many bucket arrays as plain inserts rehash into
+  auto before = allocations;
+  labels inserted;
+  for (auto const& arg : args) {
+    std::string_view const kv = std::string_view(arg).substr(8);
+    inserted.try_emplace(kv.substr(0, kv.find('=')), "v");
+  }
+  auto const expected = allocations - before;
+
+  before = allocations;
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(expected, allocations - before);
+  EXPECT_EQ(inserted.bucket_count(), parsed.bucket_count());
+}
+
+TEST(ArgParser, lazy_unordered_map_reserves_once) {
+  using labels = std::unordered_map<std::string_view, std::string_view>;
+  argparse::ArgParser parser;
+  parser.add_option<labels>("label").lazy();
+
+  std::vector<std::string> args;
+  for (int i = 0; i < 1000; i++) {
+    args.push_back("--label=key" + std::to_string(i) + "=value");
+  }
+  std::vector<const char*> cmd{"test"};
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  // the nodes and a single bucket array for all of them
+  auto const before = allocations;
+  parser.validate();
+  EXPECT_EQ(args.size() + 1, allocations - before);
+}
+
+TEST(ErasedValue, moves_heap_value_by_pointer) {
+  // larger than the buffer of ErasedValue
+  using names = std::array<std::string, 3>;
+  auto held = argparse::ErasedValue::holding(names{"a", "b", "c"});
+  auto const* value = held.get_if<names>();
+
+  auto const before = allocations;
+  argparse::ErasedValue moved(std::move(held));
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_EQ(value, moved.get_if<names>());
+  EXPECT_EQ(nullptr, held.get_if<names>());
+  EXPECT_EQ("c", (*moved.get_if<names>())[2]);
+}
+
+TEST(ErasedValue, holds_scalars_in_place) {
+  auto const before = allocations;
+  auto offset = argparse::ErasedValue::holding(std::int64_t{-1});
+  auto rate = argparse::ErasedValue::holding(0.5F);
+  argparse::ErasedValue moved(std::move(offset));
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_EQ(-1, *moved.get_if<std::int64_t>());
+  EXPECT_EQ(0.5F, *rate.get_if<float>());
+}
+
+struct Limits {
+  int files{1024};
+  int processes{64};
+  double cpu{0.5};
+  bool core{false};
+  std::uint64_t stack{8};
+};
+
+constexpr argparse::StructField<Limits> limits_fields[] = {
+    argparse::field<&Limits::files>("n,files"),
+    argparse::field<&Limits::processes>("u,processes"),
+    argparse::field<&Limits::cpu>("cpu"),
+    argparse::field<&Limits::core>("c,core,!no-core"),
+    argparse::field<&Limits::stack>("s,stack")};
+
+TEST(ArgParser, bind_struct_allocates_per_struct) {
+  Limits limits;
+  argparse::ArgParser parser;
+
+  // the copy reset() restores from, the field list and the list of copies,
+  // nothing per field
+  auto before = allocations;
+  parser.bind_struct(limits, limits_fields);
+  EXPECT_EQ(3U, allocations - before);
+
+  std::vector<const char*> const cmd{"test", "-n4096", "--cpu=0.25", "-c",
+                                     "--stack", "16"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(4096, limits.files);
+  EXPECT_TRUE(limits.core);
+
+  before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    parser.reset();
+    parser.parse(cmd.size(), cmd.data());
+  }
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_EQ(16U, limits.stack);
+}
+
+TEST(ArgParser, fixed_arity_does_not_allocate) {
+  argparse::ArgParser parser;
+  std::array<int, 2> geometry{};
+  std::tuple<int, int, double> range;
+  parser.add_option("geometry", geometry);
+  parser.add_option("range", range, ':');
+
+  std::vector<const char*> cmd{"test", "--geometry=1920,1080",
+                               "--range=1:10:0.5"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+
+  auto const before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    parser.reset();
+    parser.parse(cmd.size(), cmd.data());
+  }
+  EXPECT_EQ(0U, allocations - before);
+  EXPECT_EQ(1080, geometry[1]);
+  EXPECT_EQ(0.5, std::get<2>(range));
+}
@@ -7,6 +7,12 @@ TEST(BindableTypeInfo, name) {
   ASSERT_EQ(bindable_type_info<int>::name(), "int");
   ASSERT_EQ(bindable_type_info<double>::name(), "double");
   ASSERT_EQ(bindable_type_info<std::string>::name(), "std::string");
+  ASSERT_EQ(bindable_type_info<std::int64_t>::name(), "std::int64_t");
+  ASSERT_EQ(bindable_type_info<std::uint64_t>::name(), "std::uint64_t");
+  ASSERT_EQ(bindable_type_info<float>::name(), "float");
+  if constexpr (!std::is_same_v<std::size_t, std::uint64_t>) {
+    ASSERT_EQ(bindable_type_info<std::size_t>::name(), "std::size_t");
+  }
 
   // pair
   ASSERT_EQ((bindable_type_info<std::pair<bool, bool>>::name()),
@@ -42,4 +48,6 @@ TEST(BindableTypeInfo, name) {
 
   ASSERT_EQ((bindable_type_info<std::map<std::string, int>>::name()),
             "std::map<std::string,int>");
+  ASSERT_EQ((bindable_type_info<std::map<std::string, std::uint64_t>>::name()),
+            "std::map<std::string,std::uint64_t>");
 }
@@ -0,0 +1,68 @@
+// Builds the strtod_l() path that stands in for floating-point
+// std::from_chars on standard libraries which lack it.
+#define ARGPARSE_HAS_FLOAT_FROM_CHARS 0
+
+#include <gtest/gtest.h>
+#include <clocale>
+#include "argparse.hpp"
+
+TEST(FloatFallback, from_chars_all) {
+  using argparse::from_chars_all;
+  double d = -1;
+  ASSERT_EQ(from_chars_all("3.25", d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, 3.25);
+  ASSERT_EQ(from_chars_all("+1e3", d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, 1000);
+  ASSERT_EQ(from_chars_all("-.5", d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, -0.5);
+
+  float f = -1;
+  ASSERT_EQ(from_chars_all("0.125", f), std::errc{});
+  ASSERT_FLOAT_EQ(f, 0.125F);
+
+  // only the parsed prefix of a longer view is converted
+  std::string_view const list = "1.5,2.5";
+  ASSERT_EQ(from_chars_all(list.substr(0, 3), d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, 1.5);
+
+  // the same rejections as std::from_chars, and to is left untouched
+  d = 7;
+  for (std::string_view bad : {"", " 1", "++1", "+-1", "1.5x", "0x10", "1e",
+                               "-", "1,5"}) {
+    ASSERT_NE(from_chars_all(bad, d), std::errc{}) << bad;
+    ASSERT_DOUBLE_EQ(d, 7) << bad;
+  }
+  ASSERT_EQ(from_chars_all("1e999", d), std::errc::result_out_of_range);
+  ASSERT_EQ(from_chars_all("1e99", f), std::errc::result_out_of_range);
+  ASSERT_DOUBLE_EQ(d, 7);
+
+  // a long argument does not fit the stack copy
+  std::string const long_number = "1." + std::string(100, '0') + "1";
+  ASSERT_EQ(from_chars_all(long_number, d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, 1.0);
+}
+
+TEST(FloatFallback, ignores_global_locale) {
+  // de_DE uses ',' as the decimal point; it may not be installed
+  if (std::setlocale(LC_ALL, "de_DE.UTF-8") == nullptr) {
+    GTEST_SKIP();
+  }
+  double d = 0;
+  ASSERT_EQ(argparse::from_chars_all("2.5", d), std::errc{});
+  ASSERT_DOUBLE_EQ(d, 2.5);
+  std::setlocale(LC_ALL, "C");
+}
+
+TEST(FloatFallback, options) {
+  argparse::ArgParser parser;
+  auto& ratio = parser.add_option<double>("r");
+  auto& scales = parser.add_option<std::vector<float>>("s");
+  std::vector<const char*> const cmd{"test", "-r", "0.75", "-s1.5", "-s-2"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  ASSERT_DOUBLE_EQ(ratio.get<double>(), 0.75);
+  ASSERT_EQ(scales.get<std::vector<float>>(), (std::vector<float>{1.5F, -2}));
+
+  std::vector<const char*> const bad{"test", "-r", "0.75s"};
+  ASSERT_THROW(parser.parse(bad.size(), bad.data()),
+               argparse::bad_value_access);
+}
@@ -1,5 +1,9 @@
 #include "argparse.hpp"
 #include <gtest/gtest.h>
+#include <bitset>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
 
 TEST(Base, count0) {
   argparse::ArgParser parser;
@@ -302,3 +306,1114 @@ TEST(ArgParser, negate) {
 
   EXPECT_FALSE(is_release);
 }
+
+TEST(ArgParser, duplicate_names) {
+  argparse::ArgParser parser;
+  parser.add_flag("v,verbose");
+  parser.add_option("V,verbose");
+  ASSERT_THROW(parser.compile(), std::logic_error);
+
+  argparse::ArgParser parser2;
+  parser2.add_flag("d,debug,!r,!release");
+  parser2.add_flag("r");
+  std::vector<const char*> cmd{"test", "-d"};
+  ASSERT_THROW(parser2.parse(cmd.size(), cmd.data()), std::logic_error);
+}
+
+TEST(ArgParser, positional_named_like_option) {
+  argparse::ArgParser parser;
+  parser.add_option("f,file");
+  std::string input;
+  parser.add_positional("file", input);
+  std::vector<const char*> cmd{"test", "--file=a.txt", "b.txt"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  // get() looks up flags and options before positionals
+  EXPECT_TRUE(parser["file"].is_option());
+  EXPECT_EQ("a.txt", parser["file"].get<std::string>());
+  EXPECT_EQ("b.txt", input);
+}
+
+TEST(ArgParser, alias_target_not_found) {
+  argparse::ArgParser parser;
+  parser.add_alias_flag("G", {"color", "auto"});
+  ASSERT_THROW(parser.compile(), std::logic_error);
+}
+
+TEST(ArgParser, lookup_negate_name) {
+  argparse::ArgParser parser;
+  bool is_debug{false};
+  parser.add_flag("d,debug,!r,!release", is_debug);
+  parser.add_positional("files");
+
+  ASSERT_TRUE(parser.get("release").has_value());
+  ASSERT_TRUE(parser["r"].is_flag());
+  ASSERT_TRUE(parser["files"].is_positional());
+  ASSERT_FALSE(parser.get("x").has_value());
+
+  std::vector<const char*> cmd{"test", "--debug", "--release", "-dr"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  ASSERT_FALSE(is_debug);
+  ASSERT_EQ(4, parser["debug"].count());
+
+  cmd = {"test", "--files"};
+  ASSERT_THROW(parser.parse(cmd.size(), cmd.data()), std::invalid_argument);
+}
+
+TEST(ArgParser, many_options) {
+  argparse::ArgParser parser;
+  for (int i = 0; i < 600; i++) {
+    parser.add_option<int>("option-" + std::to_string(i));
+  }
+  std::vector<std::string> args{"test"};
+  for (int i = 0; i < 600; i += 7) {
+    args.push_back("--option-" + std::to_string(i) + "=" + std::to_string(i));
+  }
+  std::vector<const char*> cmd;
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  for (int i = 0; i < 600; i++) {
+    auto& opt = parser["option-" + std::to_string(i)];
+    ASSERT_EQ(opt.get<int>(), i % 7 == 0 ? i : 0);
+    ASSERT_EQ(opt.count(), i % 7 == 0 ? 1 : 0);
+  }
+}
+
+TEST(ArgParser, short_cluster) {
+  argparse::ArgParser parser;
+  int verbose{0};
+  std::string color;
+  std::string level;
+  parser.add_flag("v,!q", verbose);
+  parser.add_flag("i");
+  parser.add_option("color", color);
+  parser.add_alias_flag("G", {"color", "auto"});
+  parser.add_option("O", level);
+
+  std::vector<const char*> cmd{"test", "-vvvqiGiO2"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(2, verbose);
+  EXPECT_EQ(4, parser["v"].count());
+  EXPECT_EQ(2, parser["i"].count());
+  EXPECT_EQ("auto", color);
+  EXPECT_EQ("2", level);
+
+  cmd = {"test", "-vx"};
+  ASSERT_THROW(parser.parse(cmd.size(), cmd.data()), std::invalid_argument);
+  cmd = {"test", "-\xff"};
+  ASSERT_THROW(parser.parse(cmd.size(), cmd.data()), std::invalid_argument);
+}
+
+TEST(ArgParser, values_sliced_from_argv) {
+  argparse::ArgParser parser;
+  std::string name;
+  std::map<std::string, std::string> env;
+  std::vector<std::string> files;
+  parser.add_option("n,name", name);
+  parser.add_option("e,env", env);
+  parser.add_positional("files", files);
+
+  std::vector<const char*> cmd{"test",         "--name=a=b", "-eK=V",
+                               "--env=X=1=2",  "-e",         "Y=",
+                               "file0",        "--",         "-file1"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ("a=b", name);
+  EXPECT_EQ(3, env.size());
+  EXPECT_EQ("V", env["K"]);
+  EXPECT_EQ("1=2", env["X"]);
+  EXPECT_EQ("", env["Y"]);
+  EXPECT_EQ((std::vector<std::string>{"file0", "-file1"}), files);
+}
+
+TEST(ArgParser, dash_dash_without_positional) {
+  argparse::ArgParser parser;
+  parser.add_flag("v");
+  std::vector<const char*> cmd{"test", "-v", "--", "file"};
+  ASSERT_THROW(parser.parse(cmd.size(), cmd.data()), std::invalid_argument);
+}
+
+TEST(ArgParser, rebind_alias_flag) {
+  argparse::ArgParser parser;
+  std::string color;
+  int alias_count{0};
+  parser.add_option("color", color);
+  parser.add_alias_flag("G", {"color", "auto"}).bind(alias_count);
+  std::vector<const char*> cmd{"test", "-GG"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(2, alias_count);
+  EXPECT_EQ("auto", color);
+}
+
+TEST(ArgParser, strict_numbers) {
+  argparse::ArgParser parser;
+  parser.add_option<double>("d");
+  parser.add_option<int>("i");
+
+  std::vector<const char*> cmd{"test", "-d+1.5e3", "-i+42"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(1500.0, parser["d"].get<double>());
+  EXPECT_EQ(42, parser["i"].get<int>());
+
+  for (auto const* bad : {"-d1.5abc", "-d1e999", "-d+-1", "-d 1", "-i12x",
+                          "-i99999999999"}) {
+    cmd = {"test", bad};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << bad;
+  }
+
+  float f{0};
+  argparse::transform_value("-0.25", f);
+  EXPECT_EQ(-0.25F, f);
+  EXPECT_THROW(argparse::transform_value("0.25f", f),
+               argparse::bad_value_access);
+  EXPECT_EQ(-0.25F, f);
+}
+
+TEST(ArgParser, erased_types) {
+  argparse::ArgParser parser;
+  std::uint64_t bytes{0};
+  std::vector<float> rates;
+  parser.add_option("b,bytes", bytes);
+  parser.add_option<std::int64_t>("o,offset").set_default(std::int64_t{-1});
+  parser.add_option("r,rate", rates);
+  parser.add_option<std::map<std::string, std::size_t>>("l,limit");
+  parser.add_option<std::pair<int, int>>("s,size", 'x');
+  argparse::Handle<std::int64_t> offset = parser["offset"];
+  auto const spec = parser.freeze();
+
+  std::vector<const char*> cmd{"test",
+                               "--bytes=18446744073709551615",
+                               "--offset=-9223372036854775808",
+                               "-r0.5",
+                               "-r0.25",
+                               "-lx=1",
+                               "-ly=2",
+                               "-s3x4"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(UINT64_MAX, bytes);
+  EXPECT_EQ(INT64_MIN, offset.get());
+  EXPECT_EQ((std::vector<float>{0.5F, 0.25F}), rates);
+  EXPECT_EQ((std::map<std::string, std::size_t>{{"x", 1}, {"y", 2}}),
+            (parser["l"].get<std::map<std::string, std::size_t>>()));
+  EXPECT_EQ((std::pair<int, int>{3, 4}),
+            (parser["s"].get<std::pair<int, int>>()));
+  EXPECT_THROW(parser["b"].get<int>(), argparse::bad_value_access);
+  EXPECT_THROW(parser["o"].set_default(1), argparse::bad_value_access);
+
+  auto const result = spec.parse(cmd.size(), cmd.data());
+  EXPECT_EQ(INT64_MIN, offset.get(result));
+  EXPECT_EQ(UINT64_MAX, result["bytes"].get<std::uint64_t>());
+
+  parser.reset();
+  EXPECT_EQ(0U, bytes);
+  EXPECT_EQ(-1, offset.get());
+  EXPECT_TRUE(rates.empty());
+
+  cmd = {"test", "--bytes=-1"};
+  EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+               argparse::bad_value_access);
+}
+
+TEST(ArgParser, byte_sizes) {
+  argparse::ArgParser parser;
+  argparse::ByteSize cache;
+  std::vector<argparse::ByteSize> limits;
+  parser.add_option("cache-size", cache);
+  parser.add_option("l,limit", limits);
+
+  std::vector<const char*> cmd{"test", "--cache-size=512M", "-l4KiB", "-l1k",
+                               "-l15EiB", "-l0", "-l18446744073709551615B"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  std::uint64_t const bytes = cache;
+  EXPECT_EQ(512000000U, bytes);
+  ASSERT_EQ(5U, limits.size());
+  EXPECT_EQ(4096U, limits[0].bytes);
+  EXPECT_EQ(1000U, limits[1].bytes);
+  EXPECT_EQ(std::uint64_t{15} << 60U, limits[2].bytes);
+  EXPECT_EQ(0U, limits[3].bytes);
+  EXPECT_EQ(UINT64_MAX, limits[4].bytes);
+  EXPECT_EQ("argparse::ByteSize",
+            argparse::bindable_type_info<argparse::ByteSize>::name());
+
+  for (auto const* bad :
+       {"--cache-size=16EiB", "--cache-size=1X", "--cache-size=-1K",
+        "--cache-size=M", "--cache-size=1.5G",
+        "--cache-size=18446744073709551616"}) {
+    parser.reset();
+    cmd = {"test", bad};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << bad;
+  }
+}
+
+TEST(ArgParser, durations) {
+  using namespace std::chrono_literals;
+  argparse::ArgParser parser;
+  std::chrono::nanoseconds timeout{};
+  std::chrono::seconds interval{};
+  std::vector<std::chrono::milliseconds> delays;
+  parser.add_option("timeout", timeout);
+  parser.add_option("interval", interval);
+  parser.add_option("d,delay", delays);
+
+  std::vector<const char*> cmd{"test", "--timeout=250ms", "--interval=30",
+                               "-d1s",  "-d-5ms",         "-d2min",
+                               "-d1h",  "-d1500us"};
+  EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+               argparse::bad_value_access);
+  cmd.pop_back();
+  parser.reset();
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(250ms, timeout);
+  EXPECT_EQ(30s, interval);
+  EXPECT_EQ((std::vector<std::chrono::milliseconds>{1s, -5ms, 2min, 1h}),
+            delays);
+
+  for (auto const* bad : {"--interval=1500ms", "--interval=1x",
+                          "--interval=s", "--timeout=1e3ms",
+                          "--timeout=1000000d"}) {
+    parser.reset();
+    cmd = {"test", bad};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << bad;
+  }
+  EXPECT_EQ("std::chrono::nanoseconds",
+            argparse::bindable_type_info<std::chrono::nanoseconds>::name());
+  EXPECT_EQ("std::chrono::duration<1/100>",
+            (argparse::bindable_type_info<
+                std::chrono::duration<int, std::centi>>::name()));
+}
+
+TEST(ArgParser, value_placeholders) {
+  argparse::ArgParser parser;
+  parser.add_option<argparse::ByteSize>("cache-size");
+  parser.add_option<std::vector<std::chrono::milliseconds>>("delay");
+  parser.add_option<std::chrono::seconds>("timeout").value_help("SECONDS");
+  parser.add_option("name");
+  auto const usage = parser.usage();
+  EXPECT_NE(std::string::npos, usage.find("--cache-size=<SIZE>"));
+  EXPECT_NE(std::string::npos, usage.find("--delay=<DURATION>"));
+  EXPECT_NE(std::string::npos, usage.find("--timeout=<SECONDS>"));
+  EXPECT_NE(std::string::npos, usage.find("--name=<TEXT>"));
+}
+
+enum class Color { Auto, Always, Never };
+enum class Level { Low, High };
+
+namespace argparse {
+template <>
+struct enum_names<Color> {
+  static constexpr Keyword<Color> values[] = {{"auto", Color::Auto},
+                                              {"always", Color::Always},
+                                              {"never", Color::Never}};
+};
+template <>
+struct enum_names<Level> {
+  static constexpr Keyword<Level> values[] = {{"low", Level::Low},
+                                              {"LOW", Level::High}};
+};
+}  // namespace argparse
+
+TEST(ArgParser, enums) {
+  argparse::ArgParser parser;
+  Color color{Color::Auto};
+  std::vector<Color> palette;
+  parser.add_option("color", color);
+  parser.add_option("p,palette", palette);
+  parser.add_option<std::map<std::string, Color>>("c,colors");
+  parser.add_positional<Color>("mode");
+
+  std::vector<const char*> cmd{"test",   "--color=never", "-pAlways",
+                               "-pauto", "-cx=auto",      "always"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(Color::Never, color);
+  EXPECT_EQ((std::vector<Color>{Color::Always, Color::Auto}), palette);
+  EXPECT_EQ((std::map<std::string, Color>{{"x", Color::Auto}}),
+            (parser["colors"].get<std::map<std::string, Color>>()));
+  EXPECT_EQ(Color::Always, parser["mode"].get<Color>());
+  EXPECT_NE(std::string::npos,
+            parser.usage().find("--color=<auto|always|never>"));
+
+  parser.reset();
+  EXPECT_EQ(Color::Auto, color);
+  cmd = {"test", "--color=sometimes", "never"};
+  try {
+    parser.parse(cmd.size(), cmd.data());
+    ADD_FAILURE() << "sometimes is not a color";
+  } catch (argparse::bad_value_access const& e) {
+    EXPECT_NE(std::string::npos,
+              std::string(e.what()).find("auto|always|never"));
+  }
+
+  EXPECT_EQ("enum{auto|always|never}",
+            argparse::bindable_type_info<Color>::name());
+  EXPECT_THROW(parser.add_option<Level>("level"), std::logic_error);
+}
+
+TEST(ArgParser, string_views) {
+  argparse::ArgParser parser;
+  std::string_view name;
+  std::vector<std::string_view> files;
+  parser.add_option("n,name", name);
+  parser.add_option<std::string_view>("o,output")
+      .set_default(std::string_view("a.out"));
+  parser.add_option<std::map<std::string_view, std::string_view>>("D");
+  parser.add_option<std::vector<std::vector<std::string_view>>>("tags");
+  parser.add_alias_flag("release", {"o", "release.out"});
+  parser.add_positional("files", files);
+
+  std::vector<const char*> cmd{"test",      "--name=a=b", "-DK=V",
+                               "--tags=x,y", "--release",  "file0",
+                               "--",         "-file1"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ("a=b", name);
+  EXPECT_EQ(cmd[1] + 7, name.data());
+  EXPECT_EQ("release.out", parser["o"].get<std::string_view>());
+  auto const& defines =
+      parser["D"].get<std::map<std::string_view, std::string_view>>();
+  ASSERT_EQ(1U, defines.size());
+  EXPECT_EQ(cmd[2] + 4, defines.at("K").data());
+  EXPECT_EQ((std::vector<std::vector<std::string_view>>{{"x", "y"}}),
+            (parser["tags"].get<std::vector<std::vector<std::string_view>>>()));
+  ASSERT_EQ(2U, files.size());
+  EXPECT_EQ(cmd[5], files[0].data());
+  EXPECT_EQ(cmd[7], files[1].data());
+  EXPECT_EQ(
+      "std::vector<std::string_view>",
+      argparse::bindable_type_info<std::vector<std::string_view>>::name());
+
+  parser.reset();
+  EXPECT_TRUE(name.empty());
+  EXPECT_TRUE(files.empty());
+  EXPECT_EQ("a.out", parser["o"].get<std::string_view>());
+}
+
+TEST(ArgParser, flag_bits) {
+  argparse::ArgParser parser;
+  std::bitset<64> flags;
+  std::uint8_t small{0x80};
+  parser.add_flag("l", flags, 0)
+      .add_flag("h,!H", flags, 1, "human readable sizes")
+      .add_flag("S", flags, 2)
+      .add_flag("a,all", flags, 63);
+  std::string const q = "q";
+  parser.add_flag(q, small, 0);
+  parser.add_flag("n,!no-n", small, 7);
+  EXPECT_THROW(parser.add_flag("x", small, 8), std::logic_error);
+  EXPECT_THROW(parser.add_flag("", small, 1), std::logic_error);
+
+  std::vector<const char*> cmd{"test", "-lhS", "--all", "-q", "--no-n"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(0b111U, (flags & std::bitset<64>(0b111)).to_ullong());
+  EXPECT_TRUE(flags[63]);
+  EXPECT_EQ(0x01U, small);
+
+  // bits are read from their word, they are not options
+  EXPECT_THROW(parser["l"], argparse::option_not_found);
+  auto const usage = parser.usage();
+  EXPECT_NE(std::string::npos, usage.find(" [-a|--all] "));
+  EXPECT_NE(std::string::npos, usage.find("human readable sizes"));
+
+  parser.reset();
+  EXPECT_TRUE(flags.none());
+  EXPECT_EQ(0x80U, small);
+
+  cmd = {"test", "-hH", "-n"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_TRUE(flags.none());
+  EXPECT_EQ(0x80U, small);
+
+  // a spec parse has nowhere to keep the bits
+  EXPECT_THROW(parser.freeze(), std::logic_error);
+}
+
+TEST(ArgParser, delimited_lists) {
+  argparse::ArgParser parser;
+  std::vector<std::vector<int>> ids;
+  parser.add_option("ids", ids);
+  parser.add_option<std::vector<std::vector<double>>>("w", ':');
+  parser.add_option<std::vector<std::vector<std::string>>>("tags");
+
+  std::vector<const char*> cmd{"test",   "--ids=1,-2,3", "--ids=4",
+                               "-w0.5:1", "--tags=a,,b"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((std::vector<std::vector<int>>{{1, -2, 3}, {4}}), ids);
+  EXPECT_EQ((std::vector<std::vector<double>>{{0.5, 1}}),
+            parser["w"].get<std::vector<std::vector<double>>>());
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{"a", "", "b"}}),
+            parser["tags"].get<std::vector<std::vector<std::string>>>());
+
+  // split like StringUtil::split(): a trailing delimiter ends the list and
+  // a doubled one makes an empty element, which only a string accepts
+  parser.reset();
+  cmd = {"test", "--ids=1,2,", "-w0.5:", "--tags=a,b,", "--tags=a,,"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((std::vector<std::vector<int>>{{1, 2}}), ids);
+  EXPECT_EQ((std::vector<std::vector<double>>{{0.5}}),
+            parser["w"].get<std::vector<std::vector<double>>>());
+  EXPECT_EQ((std::vector<std::vector<std::string>>{{"a", "b"}, {"a", ""}}),
+            parser["tags"].get<std::vector<std::vector<std::string>>>());
+
+  for (auto const* bad : {"--ids=1,,2", "--ids=1,,", "--ids=,1", "--ids=1;2"}) {
+    cmd = {"test", bad};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << bad;
+  }
+
+  std::string list;
+  for (int i = 0; i < 1000; i++) {
+    list += (i == 0 ? "--ids=" : ",") + std::to_string(i);
+  }
+  parser.reset();
+  cmd = {"test", list.c_str()};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  ASSERT_EQ(1U, ids.size());
+  ASSERT_EQ(1000U, ids[0].size());
+  EXPECT_EQ(1000U, ids[0].capacity());
+  EXPECT_EQ(999, ids[0].back());
+}
+
+TEST(StringUtil, split) {
+  using argparse::StringUtil::split;
+  using views = std::vector<std::string_view>;
+  EXPECT_EQ(views{}, split("", ','));
+  EXPECT_EQ((views{"a", "b"}), split("a,b", ','));
+  EXPECT_EQ((views{"a", "b"}), split("a,b,", ','));
+  EXPECT_EQ((views{"", "a", "", "b"}), split(",a,,b", ','));
+  EXPECT_EQ((views{"a", "b,c"}), split("a,b,c", ',', 1));
+
+  std::string const desc = "v, verbose";
+  auto const parts = split(desc, ',');
+  ASSERT_EQ(2U, parts.size());
+  EXPECT_EQ(desc.data() + 2, parts[1].data());
+}
+
+TEST(StringUtil, trim) {
+  using argparse::StringUtil::strip_dashes;
+  using argparse::StringUtil::trim;
+  EXPECT_EQ("", trim(""));
+  EXPECT_EQ("", trim(" \t "));
+  EXPECT_EQ("a b", trim(" a b\n"));
+  EXPECT_EQ("name", strip_dashes("--name"));
+  EXPECT_EQ("n", strip_dashes("-n"));
+  EXPECT_EQ("-name", strip_dashes("---name"));
+  EXPECT_TRUE(argparse::StringUtil::startswith("--x", "--"));
+  EXPECT_FALSE(argparse::StringUtil::startswith("-", "--"));
+}
+
+TEST(StringUtil, count) {
+  using argparse::StringUtil::count;
+  EXPECT_EQ(0U, count("", ','));
+  EXPECT_EQ(2U, count("1,2,3", ','));
+  std::string str(100, 'x');
+  for (std::size_t i = 0; i < str.size(); i += 7) {
+    str[i] = ',';
+  }
+  EXPECT_EQ(15U, count(str, ','));
+  EXPECT_EQ(14U, count(std::string_view(str).substr(0, 98), ','));
+  EXPECT_EQ(13U, count(std::string_view(str).substr(1, 97), ','));
+}
+
+TEST(ArgParser, bool_keywords) {
+  argparse::ArgParser parser;
+  parser.add_option<bool>("color");
+  for (auto const* arg : {"--color=true", "--color=YES", "--color=On",
+                          "--color=1"}) {
+    std::vector<const char*> cmd{"test", "--color=false", arg};
+    ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data())) << arg;
+    EXPECT_TRUE(parser["color"].get<bool>()) << arg;
+  }
+  for (auto const* arg : {"--color=False", "--color=no", "--color=OFF",
+                          "--color=0"}) {
+    std::vector<const char*> cmd{"test", "--color=true", arg};
+    ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data())) << arg;
+    EXPECT_FALSE(parser["color"].get<bool>()) << arg;
+  }
+  for (auto const* arg : {"--color=2", "--color=yess", "--color=o"}) {
+    std::vector<const char*> cmd{"test", arg};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << arg;
+  }
+}
+
+TEST(Keyword, find_keyword) {
+  enum class When { NEVER, ALWAYS, AUTO };
+  static constexpr argparse::Keyword<When> when[] = {
+      {"never", When::NEVER}, {"always", When::ALWAYS}, {"auto", When::AUTO}};
+  ASSERT_NE(nullptr, argparse::find_keyword("Always", when));
+  EXPECT_EQ(When::ALWAYS, *argparse::find_keyword("Always", when));
+  EXPECT_EQ(When::AUTO, *argparse::find_keyword("AUTO", when));
+  EXPECT_EQ(nullptr, argparse::find_keyword("automatic", when));
+  EXPECT_EQ(nullptr, argparse::find_keyword("", when));
+
+  std::vector<argparse::Keyword<int>> levels{{"low", 1}, {"high", 2}};
+  EXPECT_EQ(2, *argparse::find_keyword("HIGH", levels));
+}
+
+TEST(ArgParser, map_insertion) {
+  argparse::ArgParser parser;
+  std::map<std::string, int> limits;
+  parser.add_option("l", limits);
+
+  std::vector<const char*> cmd{"test", "-la=1", "-lb=2", "-la=3", "-lc"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  // the first value of a key is kept, a value without '=' is {"", 0}
+  EXPECT_EQ((std::map<std::string, int>{{"a", 1}, {"b", 2}, {"", 0}}),
+            limits);
+
+  cmd = {"test", "-la=1", "-la=x"};
+  EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+               argparse::bad_value_access);
+}
+
+TEST(ArgParser, unordered_maps) {
+  argparse::ArgParser parser;
+  std::unordered_map<std::string, std::string> settings;
+  std::unordered_map<std::string_view, int> labels;
+  parser.add_option("set", settings);
+  parser.add_option("l,label", labels, ':');
+  parser.add_option<std::unordered_map<std::string, std::uint64_t>>("limit")
+      .lazy();
+
+  std::vector<const char*> cmd{"test",        "--set=a=1",   "--set=b=x=y",
+                               "--set=a=2",   "-lk:1",       "--label=j:2",
+                               "--limit=n=5", "--limit=m=6"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((std::unordered_map<std::string, std::string>{{"a", "1"},
+                                                          {"b", "x=y"}}),
+            settings);
+  EXPECT_EQ((std::unordered_map<std::string_view, int>{{"k", 1}, {"j", 2}}),
+            labels);
+  EXPECT_EQ(cmd[4] + 2, labels.find("k")->first.data());
+  auto const& limits =
+      parser["limit"].get<std::unordered_map<std::string, std::uint64_t>>();
+  EXPECT_EQ(2U, limits.size());
+  EXPECT_EQ(6U, limits.at("m"));
+  EXPECT_EQ("std::unordered_map<std::string_view,int>",
+            (argparse::bindable_type_info<
+                std::unordered_map<std::string_view, int>>::name()));
+
+  auto const buckets = settings.bucket_count();
+  parser.reset();
+  EXPECT_TRUE(settings.empty());
+  EXPECT_EQ(buckets, settings.bucket_count());
+  EXPECT_TRUE(
+      (parser["limit"].get<std::unordered_map<std::string, std::uint64_t>>())
+          .empty());
+}
+
+TEST(FlatMap, sort_unique) {
+  argparse::FlatMap<std::string, int> map{{"b", 1}, {"a", 2}, {"b", 3}};
+  ASSERT_EQ(2U, map.size());
+  EXPECT_EQ("a", map.begin()->first);
+  EXPECT_EQ(1, map.at("b"));
+  EXPECT_EQ(1U, map.count(std::string_view("a")));
+  EXPECT_EQ(map.end(), map.find("c"));
+  EXPECT_THROW(map.at("c"), std::out_of_range);
+
+  argparse::FlatSet<int> set{3, 1, 3, 2};
+  EXPECT_EQ((std::vector<int>{1, 2, 3}),
+            std::vector<int>(set.begin(), set.end()));
+}
+
+TEST(ArgParser, flat_containers) {
+  argparse::ArgParser parser;
+  argparse::FlatMap<std::string, int> settings;
+  argparse::FlatSet<std::string> tags;
+  parser.add_option("s,set", settings, ':');
+  parser.add_option("t,tag", tags);
+  parser.add_option<argparse::FlatMap<std::string_view, std::uint64_t>>("l")
+      .lazy();
+  auto const spec = parser.freeze();
+
+  std::vector<const char*> cmd{"test", "-sb:2", "-sa:1", "-sb:3", "-tz",
+                               "-ta",  "-tz",   "-ly=2", "-lx=1"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((argparse::FlatMap<std::string, int>{{"a", 1}, {"b", 2}}),
+            settings);
+  EXPECT_EQ((argparse::FlatSet<std::string>{"a", "z"}), tags);
+  using limits = argparse::FlatMap<std::string_view, std::uint64_t>;
+  EXPECT_EQ((limits{{"x", 1}, {"y", 2}}), parser["l"].get<limits>());
+  EXPECT_EQ("argparse::FlatMap<std::string,int>",
+            argparse::bindable_type_info<decltype(settings)>::name());
+  EXPECT_EQ("argparse::FlatSet<std::string>",
+            argparse::bindable_type_info<decltype(tags)>::name());
+
+  auto const result = spec.parse(cmd.size(), cmd.data());
+  EXPECT_EQ(
+      2, (result["s"].get<argparse::FlatMap<std::string, int>>().at("b")));
+  EXPECT_EQ((limits{{"x", 1}, {"y", 2}}), result["l"].get<limits>());
+
+  parser.reset();
+  EXPECT_TRUE(settings.empty());
+  EXPECT_TRUE(tags.empty());
+
+  // bound after the parser was compiled by a lookup
+  argparse::ArgParser rebound;
+  argparse::FlatSet<std::string> later;
+  rebound.add_flag("h,help");
+  rebound.add_option<std::vector<std::string>>("t");
+  rebound["t"].bind(later);
+  cmd = {"test", "-tz", "-ta", "-tz"};
+  ASSERT_NO_THROW(rebound.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((argparse::FlatSet<std::string>{"a", "z"}), later);
+  EXPECT_EQ(1U, later.count("a"));
+}
+
+TEST(ArgParser, fixed_arity) {
+  argparse::ArgParser parser;
+  std::array<int, 2> geometry{640, 480};
+  std::tuple<std::string, int, double> server;
+  std::vector<std::array<int, 3>> colors;
+  parser.add_option("geometry", geometry);
+  parser.add_option("server", server, ':');
+  parser.add_option("rgb", colors);
+  parser.add_option<std::tuple<int, int>>("range", ':');
+  parser.add_option<std::array<std::string, 3>>("names");
+
+  std::vector<const char*> cmd{"test",
+                               "--geometry=1920,1080",
+                               "--server=localhost:80:1.5",
+                               "--rgb=1,2,3",
+                               "--rgb=255,0,0",
+                               "--range=-5:5",
+                               "--names=a,,c"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ((std::array<int, 2>{1920, 1080}), geometry);
+  EXPECT_EQ((std::tuple<std::string, int, double>{"localhost", 80, 1.5}),
+            server);
+  EXPECT_EQ((std::vector<std::array<int, 3>>{{1, 2, 3}, {255, 0, 0}}), colors);
+  EXPECT_EQ((std::tuple<int, int>{-5, 5}),
+            (parser["range"].get<std::tuple<int, int>>()));
+  EXPECT_EQ((std::array<std::string, 3>{"a", "", "c"}),
+            (parser["names"].get<std::array<std::string, 3>>()));
+  EXPECT_EQ("std::tuple<std::string,int,double>",
+            argparse::bindable_type_info<decltype(server)>::name());
+  EXPECT_EQ("std::array<int,2>",
+            argparse::bindable_type_info<decltype(geometry)>::name());
+
+  for (auto const* bad : {"--geometry=1920", "--geometry=1,2,3",
+                          "--geometry=1,", "--geometry=1,x",
+                          "--server=localhost:80", "--rgb=1,2"}) {
+    parser.reset();
+    cmd = {"test", bad};
+    EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+                 argparse::bad_value_access)
+        << bad;
+    EXPECT_EQ((std::array<int, 2>{640, 480}), geometry) << bad;
+  }
+}
+
+struct ServerConfig {
+  bool verbose{false};
+  int jobs{1};
+  std::string output{"a.out"};
+  std::vector<std::string> includes;
+  std::map<std::string, std::string> defines;
+  std::array<int, 2> geometry{640, 480};
+  std::chrono::milliseconds timeout{100};
+  argparse::FlatSet<std::string> tags;
+};
+
+constexpr argparse::StructField<ServerConfig> server_config_fields[] = {
+    argparse::field<&ServerConfig::verbose>("v,verbose,!q", "print more"),
+    argparse::field<&ServerConfig::jobs>("j,jobs"),
+    argparse::field<&ServerConfig::output>("o,output"),
+    argparse::field<&ServerConfig::includes>("I"),
+    argparse::field<&ServerConfig::defines>("D"),
+    argparse::field<&ServerConfig::geometry>("geometry"),
+    argparse::field<&ServerConfig::timeout>("timeout"),
+    argparse::field<&ServerConfig::tags>("t,tag")};
+
+TEST(ArgParser, bind_struct) {
+  ServerConfig config;
+  argparse::ArgParser parser;
+  parser.bind_struct(config, server_config_fields);
+
+  std::vector<const char*> cmd{"test",
+                               "-vj4",
+                               "-Iinc",
+                               "-I",
+                               "src",
+                               "-DK=V",
+                               "--geometry=800,600",
+                               "--timeout=2s",
+                               "-tz",
+                               "--tag",
+                               "a",
+                               "--tag=z"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_TRUE(config.verbose);
+  EXPECT_EQ(4, config.jobs);
+  EXPECT_EQ("a.out", config.output);
+  EXPECT_EQ((std::vector<std::string>{"inc", "src"}), config.includes);
+  EXPECT_EQ("V", config.defines["K"]);
+  EXPECT_EQ((std::array<int, 2>{800, 600}), config.geometry);
+  EXPECT_EQ(std::chrono::seconds(2), config.timeout);
+  EXPECT_EQ((argparse::FlatSet<std::string>{"a", "z"}), config.tags);
+
+  // fields are read from the struct, they are not options
+  EXPECT_FALSE(parser.get("jobs").has_value());
+  EXPECT_THROW(parser.freeze(), std::logic_error);
+  auto const usage = parser.usage();
+  EXPECT_NE(std::string::npos, usage.find("[-j|--jobs <TEXT>]"));
+  EXPECT_NE(std::string::npos, usage.find("  -v, --verbose\n"
+                                          "            print more"));
+
+  parser.reset();
+  EXPECT_FALSE(config.verbose);
+  EXPECT_EQ(1, config.jobs);
+  EXPECT_TRUE(config.includes.empty());
+  EXPECT_EQ(std::chrono::milliseconds(100), config.timeout);
+  EXPECT_TRUE(config.tags.empty());
+
+  cmd = {"test", "--verbose", "-q", "--jobs", "2"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_FALSE(config.verbose);
+  EXPECT_EQ(2, config.jobs);
+
+  cmd = {"test", "--jobs"};
+  EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+               argparse::invalid_argument);
+  cmd = {"test", "--jobs=x"};
+  EXPECT_THROW(parser.parse(cmd.size(), cmd.data()),
+               argparse::bad_value_access);
+
+  // field names share the namespace of the options
+  parser.add_flag("j");
+  EXPECT_THROW(parser.compile(), std::logic_error);
+}
+
+struct Ipv4 {
+  std::uint32_t address{0};
+  bool operator==(Ipv4 const& other) const { return address == other.address; }
+  bool operator<(Ipv4 const& other) const { return address < other.address; }
+};
+
+namespace argparse {
+template <>
+struct converter<Ipv4> {
+  static void convert(std::string_view from, Ipv4& to) {
+    std::uint32_t address = 0;
+    int parts = 0;
+    StringUtil::for_each_part(from, '.', [&](std::string_view part) {
+      unsigned byte = 256;
+      if (from_chars_all(part, byte) != std::errc{} || byte > 255) {
+        throw std::invalid_argument("not an IPv4 address");
+      }
+      address = address << 8U | byte;
+      parts++;
+    });
+    if (parts != 4) {
+      throw std::invalid_argument("not an IPv4 address");
+    }
+    to.address = address;
+  }
+  static std::string name() { return "Ipv4"; }
+};
+
+template <>
+struct converter<std::filesystem::path> {
+  static void convert(std::string_view from, std::filesystem::path& to) {
+    to = from;
+  }
+};
+}  // namespace argparse
+
+TEST(ArgParser, converter) {
+  argparse::ArgParser parser;
+  Ipv4 listen;
+  std::vector<Ipv4> peers;
+  std::filesystem::path root;
+  parser.add_option("listen", listen);
+  parser.add_option("p,peer", peers);
+  parser.add_option<std::map<std::string, Ipv4>>("H,host");
+  parser.add_positional("root", root);
+
+  std::vector<const char*> cmd{"test",
+                               "--listen=127.0.0.1",
+                               "-p10.0.0.1",
+                               "-p10.0.0.2",
+                               "-Hgw=10.0.0.254",
+                               "/srv/www"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(0x7F000001U, listen.address);
+  EXPECT_EQ((std::vector<Ipv4>{{0x0A000001U}, {0x0A000002U}}), peers);
+  auto const& hosts = parser["host"].get<std::map<std::string, Ipv4>>();
+  EXPECT_EQ(0x0A0000FEU, hosts.at("gw").address);
+  EXPECT_EQ(std::filesystem::path("/srv/www"), root);
+  EXPECT_EQ("std::vector<Ipv4>",
+            argparse::bindable_type_info<std::vector<Ipv4>>::name());
+
+  parser.reset();
+  cmd = {"test", "--listen=localhost"};
+  try {
+    parser.parse(cmd.size(), cmd.data());
+    ADD_FAILURE() << "localhost is not an address";
+  } catch (argparse::bad_value_access const& e) {
+    EXPECT_STREQ("err: 'localhost' => Ipv4: not an IPv4 address", e.what());
+  }
+}
+
+TEST(ArgParser, lazy) {
+  argparse::ArgParser parser;
+  int level{0};
+  parser.add_flag("v");
+  parser.add_option<int>("n").lazy();
+  parser.add_option("l,level", level).lazy();
+  parser.add_option<std::vector<int>>("I").lazy();
+  parser.add_positional<int>("first").lazy();
+  parser.add_positional<std::vector<std::string>>("rest").lazy();
+
+  std::vector<const char*> cmd{"test", "-n",  "x",    "-l3", "-I1",
+                               "-I",   "2",   "-vv",  "7",   "a",
+                               "b"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(2, parser["v"].count());
+  EXPECT_EQ(1, parser["n"].count());
+  EXPECT_EQ(2, parser["I"].count());
+
+  // the bound variable is written by the conversion
+  EXPECT_EQ(0, level);
+  EXPECT_EQ(3, parser["level"].get<int>());
+  EXPECT_EQ(3, level);
+
+  EXPECT_EQ((std::vector<int>{1, 2}), parser["I"].get<std::vector<int>>());
+  EXPECT_EQ(7, parser["first"].get<int>());
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}),
+            parser["rest"].get<std::vector<std::string>>());
+
+  // a bad value only fails once it is converted, and keeps failing
+  EXPECT_THROW(parser.validate(), argparse::bad_value_access);
+  EXPECT_THROW(parser["n"].get<int>(), argparse::bad_value_access);
+
+  parser.reset();
+  ASSERT_NO_THROW(parser.validate());
+  EXPECT_EQ(0, parser["n"].get<int>());
+
+  // parse() leaves the bound variable alone, validate() writes it
+  level = 3;
+  cmd = {"test", "-l5"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(3, level);
+  ASSERT_NO_THROW(parser.validate());
+  EXPECT_EQ(5, level);
+}
+
+TEST(ParserSpec, lazy) {
+  argparse::ArgParser parser;
+  parser.add_option<std::vector<double>>("x").lazy();
+  parser.add_option<int>("n").lazy();
+  auto const spec = parser.freeze();
+
+  std::vector<const char*> cmd{"test", "-x1.5", "-x", "2", "-n", "4"};
+  auto const result = spec.parse(cmd.size(), cmd.data());
+  ASSERT_NO_THROW(result.validate());
+  EXPECT_EQ((std::vector<double>{1.5, 2}),
+            result["x"].get<std::vector<double>>());
+  EXPECT_EQ(4, result["n"].get<int>());
+
+  cmd = {"test", "-x1", "-xy"};
+  auto const bad = spec.parse(cmd.size(), cmd.data());
+  EXPECT_THROW(bad.validate(), argparse::bad_value_access);
+  EXPECT_THROW(bad["x"].get<std::vector<double>>(),
+               argparse::bad_value_access);
+  EXPECT_EQ(0, bad["n"].get<int>());
+}
+
+TEST(ParserSpec, lazy_shared_result) {
+  argparse::ArgParser parser;
+  parser.add_option<std::vector<int>>("n").lazy();
+  auto const spec = parser.freeze();
+
+  std::vector<std::string> args;
+  for (int i = 0; i <= 1000; i++) {
+    args.push_back("-n" + std::to_string(i));
+  }
+  std::vector<const char*> cmd{"test"};
+  for (auto const& arg : args) {
+    cmd.push_back(arg.c_str());
+  }
+  auto const result = spec.parse(cmd.size(), cmd.data());
+
+  // concurrent first get() calls convert once and see the same values
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4, 0);
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&result, &failures, t] {
+      auto const& values = result["n"].get<std::vector<int>>();
+      if (values.size() != 1001 || values.back() != 1000) {
+        failures[t]++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ((std::vector<int>(4, 0)), failures);
+}
+
+TEST(ArgParser, handle) {
+  argparse::ArgParser parser;
+  std::string output;
+  argparse::Handle<int> verbose = parser.add_flag<int>("v,!q");
+  argparse::Handle<std::string> out =
+      parser.add_option("o,output", output).help("output file");
+  argparse::Handle<std::vector<int>> numbers =
+      parser.add_option<std::vector<int>>("n").lazy();
+  argparse::Handle<std::vector<std::string>> files =
+      parser.add_positional("files");
+  EXPECT_THROW(argparse::Handle<double>{parser["v"]},
+               argparse::bad_value_access);
+
+  std::vector<const char*> cmd{"test", "-vvq", "-oa.out", "-n1",
+                               "-n",   "2",    "f"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(1, verbose.get());
+  EXPECT_EQ(3, verbose.count());
+  EXPECT_EQ("a.out", out.get());
+  EXPECT_EQ(&output, &out.get());
+  EXPECT_EQ((std::vector<int>{1, 2}), numbers.get());
+  EXPECT_EQ((std::vector<std::string>{"f"}), files.get());
+  EXPECT_EQ(&parser["n"], &numbers.option());
+
+  auto const spec = parser.freeze();
+  cmd = {"test", "-v", "-n3"};
+  auto const result = spec.parse(cmd.size(), cmd.data());
+  EXPECT_EQ(1, verbose.get(result));
+  EXPECT_EQ(1, verbose.count(result));
+  EXPECT_EQ((std::vector<int>{3}), numbers.get(result));
+  EXPECT_TRUE(files.get(result).empty());
+  // the parser keeps the values of its own parse
+  EXPECT_EQ(3, verbose.count());
+
+  // a handle follows a binding made through it
+  std::string other;
+  out.bind(other);
+  cmd = {"test", "-ob.out"};
+  ASSERT_NO_THROW(parser.parse(cmd.size(), cmd.data()));
+  EXPECT_EQ(&other, &out.get());
+  EXPECT_EQ("b.out", other);
+  EXPECT_EQ("a.out", output);
+}
+
+TEST(ParserSpec, parse) {
+  argparse::ArgParser parser;
+  int verbose{0};
+  std::string level{"info"};
+  parser.add_flag("v,!q", verbose);
+  parser.add_option("l,level", level);
+  parser.add_option<std::vector<std::string>>("I").set_default(
+      std::vector<std::string>{"/usr/include"});
+  parser.add_positional("files");
+  auto const spec = parser.freeze();
+
+  std::vector<const char*> cmd{"test", "-vvq", "--level=debug", "-Ia",
+                               "-I",   "b",    "f1",            "f2"};
+  auto const result = spec.parse(cmd.size(), cmd.data());
+  EXPECT_EQ(1, result["v"].get<int>());
+  EXPECT_EQ(3, result["v"].count());
+  EXPECT_EQ("debug", result["level"].get<std::string>());
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}),
+            result["I"].get<std::vector<std::string>>());
+  EXPECT_EQ((std::vector<std::string>{"f1", "f2"}),
+            result["files"].get<std::vector<std::string>>());
+  EXPECT_THROW(result["x"], argparse::option_not_found);
+
+  // the parser and its bindings are left alone
+  EXPECT_EQ(0, verbose);
+  EXPECT_EQ("info", level);
+  EXPECT_EQ(0, parser["v"].count());
+  EXPECT_EQ((std::vector<std::string>{"/usr/include"}),
+            parser["I"].get<std::vector<std::string>>());
+
+  auto const empty = spec.parse(1, cmd.data());
+  EXPECT_EQ(0, empty["v"].get<int>());
+  EXPECT_EQ("info", empty["level"].get<std::string>());
+  EXPECT_EQ((std::vector<std::string>{"/usr/include"}),
+            empty["I"].get<std::vector<std::string>>());
+  EXPECT_TRUE(empty["files"].get<std::vector<std::string>>().empty());
+
+  cmd = {"test", "--unknown"};
+  EXPECT_THROW(spec.parse(cmd.size(), cmd.data()), std::invalid_argument);
+}
+
+TEST(ParserSpec, concurrent_parse) {
+  argparse::ArgParser parser;
+  parser.add_option<int>("n");
+  parser.add_positional("args");
+  auto const spec = parser.freeze();
+
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4, 0);
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&spec, &failures, t] {
+      for (int i = 0; i < 500; i++) {
+        auto const n = std::to_string(t * 1000 + i);
+        std::vector<const char*> cmd{"test", "-n", n.c_str(), n.c_str()};
+        auto const result = spec.parse(cmd.size(), cmd.data());
+        auto const& args = result["args"].get<std::vector<std::string>>();
+        if (result["n"].get<int>() != t * 1000 + i || args.size() != 1 ||
+            args[0] != n) {
+          failures[t]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ((std::vector<int>{0, 0, 0, 0}), failures);
+}
+
+TEST(ParserSpec, parse_batch) {
+  argparse::ArgParser parser;
+  parser.add_option<int>("n");
+  parser.add_positional("args");
+  auto const spec = parser.freeze();
+
+  std::vector<std::string> numbers;
+  for (int i = 0; i < 1000; i++) {
+    numbers.push_back(std::to_string(i));
+  }
+  std::vector<std::vector<const char*>> argvs;
+  for (int i = 0; i < 1000; i++) {
+    if (i % 100 == 7) {
+      argvs.push_back({"test", "-x"});
+    } else {
+      // command lines of different lengths
+      std::vector<const char*> cmd{"test", "-n", numbers[i].c_str()};
+      for (int j = 0; j < i % 37; j++) {
+        cmd.push_back(numbers[j].c_str());
+      }
+      argvs.push_back(cmd);
+    }
+  }
+
+  for (unsigned threads : {1U, 3U, 8U}) {
+    auto const results = spec.parse_batch(argvs, threads);
+    ASSERT_EQ(argvs.size(), results.size());
+    for (int i = 0; i < 1000; i++) {
+      auto const& r = results[i];
+      if (i % 100 == 7) {
+        ASSERT_FALSE(r.result.has_value());
+        ASSERT_THROW(std::rethrow_exception(r.error), std::invalid_argument);
+      } else {
+        ASSERT_TRUE(r.result.has_value());
+        ASSERT_FALSE(r.error);
+        ASSERT_EQ(i, (*r.result)["n"].get<int>());
+        ASSERT_EQ(i % 37,
+                  (*r.result)["args"].get<std::vector<std::string>>().size());
+      }
+    }
+  }
+
+  EXPECT_TRUE(spec.parse_batch(std::vector<std::vector<const char*>>{})
+                  .empty());
+}